@@ -0,0 +1,333 @@
+#include <Arduino.h>
+#include <async/Executor.h>
+#include <async/Chain.h>
+#include <async/Pin.h>
+#include <atomic>
+
+/**
+ * @file SchedulerBench.cpp
+ * @brief Scheduler microbenchmarks for host and target builds
+ *
+ * @details Every result is printed as one line:
+ * @code
+ * BENCH name=<benchmark> <parameter>=<value> ... <metric>=<value>
+ * @endcode
+ * so results can be collected with grep and compared across releases.
+ *
+ * On the target, the ISR latency benchmark needs BENCH_PIN_OUT wired to BENCH_PIN_IN,
+ * e.g. build_flags = -D BENCH_PIN_OUT=18 -D BENCH_PIN_IN=19. On the host the shim drives
+ * the input directly.
+ */
+
+using namespace async;
+
+#ifndef BENCH_PIN_IN
+#define BENCH_PIN_IN 19
+#endif
+
+static const char * modeName(int mode) {
+    return mode == Executor::TIMERS ? "timers" : "poll";
+}
+
+/**
+ * @brief Cost of one Executor::tick() with N idle REPEAT tasks
+ */
+static void benchEmptyTick(int mode, int tasks) {
+    Executor executor(mode);
+    executor.start();
+
+    for(int i=0; i < tasks; i++) {
+        executor.onRepeat(3600000, []() {});
+    }
+
+    const uint32_t passes = 2000;
+    uint32_t from = micros();
+
+    for(uint32_t i=0; i < passes; i++) {
+        executor.tick();
+    }
+
+    uint32_t elapsed = micros() - from;
+
+    Serial.printf("BENCH name=empty_tick mode=%s tasks=%d passes=%u ns_per_tick=%llu\n", 
+        modeName(mode), tasks, passes, (unsigned long long) elapsed * 1000ULL / passes);
+}
+
+/**
+ * @brief Lateness of REPEAT callbacks relative to their nominal period
+ */
+static void benchRepeatJitter(int mode, uint32_t periodUs, int load, int policy = Task::FIXED_DELAY) {
+    Executor executor(mode);
+    executor.start();
+
+    for(int i=0; i < load; i++) {
+        executor.onRepeat(3600000, []() {});
+    }
+
+    const int fires = 100;
+    uint32_t stamps[fires];
+    int count = 0;
+
+    executor.onRepeat(Duration::us(periodUs), [&]() {
+        if(count < fires) {
+            stamps[count++] = micros();
+        }
+    })->setPolicy(policy);
+
+    while(count < fires) {
+        executor.tick();
+    }
+
+    uint32_t minimum = UINT32_MAX, maximum = 0;
+    uint64_t sum = 0;
+
+    for(int i=1; i < fires; i++) {
+        uint32_t interval = stamps[i] - stamps[i - 1];
+        minimum = min(minimum, interval);
+        maximum = max(maximum, interval);
+        sum += interval;
+    }
+
+    uint32_t drift = (stamps[fires - 1] - stamps[0]) - (fires - 1) * periodUs;
+
+    Serial.printf("BENCH name=repeat_jitter mode=%s policy=%s period_us=%u load=%d fires=%d "
+                  "interval_min_us=%u interval_avg_us=%llu interval_max_us=%u drift_us=%d\n",
+        modeName(mode), policy == Task::FIXED_DELAY ? "fixed_delay" : "catch_up", periodUs, load, fires, minimum, 
+        (unsigned long long) sum / (fires - 1), maximum, (int) drift);
+}
+
+/**
+ * @brief Lateness of a 1 ms control task sharing the loop with slow polled tasks
+ */
+static void benchPriority(bool prioritize, uint32_t budget) {
+    Executor executor;
+    executor.start();
+    executor.setBudget(budget);
+
+    for(int i=0; i < 5; i++) {
+        executor.onTick([]() {
+            uint32_t from = micros();
+            while(micros() - from < 300) {}
+        })->setPriority(Tick::PRIORITY_LOW);
+    }
+
+    const int fires = 100;
+    uint32_t stamps[fires];
+    int count = 0;
+
+    Task * control = new Task(Task::REPEAT, Duration::us(1000), [&]() {
+        if(count < fires) {
+            stamps[count++] = micros();
+        }
+    });
+    control->setPolicy(Task::CATCH_UP);
+    control->setPriority(prioritize ? Tick::PRIORITY_HIGH : Tick::PRIORITY_LOW);
+    executor.add(control);
+
+    while(count < fires) {
+        executor.tick();
+    }
+
+    uint32_t maximum = 0;
+
+    for(int i=1; i < fires; i++) {
+        maximum = max(maximum, stamps[i] - stamps[i - 1]);
+    }
+
+    Serial.printf("BENCH name=priority prioritized=%d budget_us=%u interval_max_us=%u deferrals=%u\n",
+        prioritize ? 1 : 0, budget, maximum, executor.getDeferrals());
+}
+
+/**
+ * @brief Throughput of creating and removing DELAY tasks
+ */
+static void benchChurn(int mode, int resident) {
+    Executor executor(mode);
+    executor.start();
+
+    for(int i=0; i < resident; i++) {
+        executor.onRepeat(3600000, []() {});
+    }
+
+    const uint32_t cycles = 10000;
+    uint32_t from = micros();
+
+    for(uint32_t i=0; i < cycles; i++) {
+        Task * task = executor.onDelay(3600000, []() {});
+        executor.remove(task);
+    }
+
+    uint32_t elapsed = micros() - from;
+
+    Serial.printf("BENCH name=add_remove mode=%s resident=%d cycles=%u ns_per_cycle=%llu\n",
+        modeName(mode), resident, cycles, (unsigned long long) elapsed * 1000ULL / cycles);
+}
+
+/**
+ * @brief Throughput of Chain THEN steps
+ */
+static void benchChainSteps(int steps) {
+    Executor executor;
+    executor.start();
+
+    uint32_t done = 0;
+    auto ch = chain();
+
+    for(int i=0; i < steps; i++) {
+        ch->then([&done]() { done++; });
+    }
+
+    executor.add(ch->loop());
+
+    const uint32_t target = 20000;
+    uint32_t from = micros();
+
+    while(done < target) {
+        executor.tick();
+    }
+
+    uint32_t elapsed = micros() - from;
+
+    Serial.printf("BENCH name=chain_steps steps=%d executed=%u ns_per_step=%llu\n",
+        steps, done, (unsigned long long) elapsed * 1000ULL / done);
+}
+
+/**
+ * @brief Delay between an input edge and the Pin::onInterrupt callback
+ */
+static void benchInterruptLatency() {
+#if defined(ASYNC_HOST) || defined(BENCH_PIN_OUT)
+    Executor executor;
+    Pin * input = new Pin(BENCH_PIN_IN, INPUT_PULLUP);
+    executor.start();
+    executor.add(input);
+
+    std::atomic<uint32_t> fired(0);
+    std::atomic<uint32_t> stamp(0);
+
+    input->onInterrupt(FALLING, [&]() {
+        stamp = micros();
+        fired++;
+    });
+
+    const int edges = 200;
+    uint32_t minimum = UINT32_MAX, maximum = 0;
+    uint64_t sum = 0;
+
+    for(int i=0; i < edges; i++) {
+        uint32_t expected = fired + 1;
+        uint32_t from = micros();
+
+    #if defined(ASYNC_HOST)
+        host::setPin(BENCH_PIN_IN, LOW);
+    #else
+        digitalWrite(BENCH_PIN_OUT, LOW);
+    #endif
+
+        while(fired < expected) {
+            executor.tick();
+        }
+
+        uint32_t latency = stamp - from;
+        minimum = min(minimum, latency);
+        maximum = max(maximum, latency);
+        sum += latency;
+
+    #if defined(ASYNC_HOST)
+        host::setPin(BENCH_PIN_IN, HIGH);
+    #else
+        digitalWrite(BENCH_PIN_OUT, HIGH);
+    #endif
+
+        executor.tick();
+    }
+
+    Serial.printf("BENCH name=isr_latency edges=%d latency_min_us=%u latency_avg_us=%llu latency_max_us=%u\n",
+        edges, minimum, (unsigned long long) sum / edges, maximum);
+#else
+    Serial.println("BENCH name=isr_latency skipped=1");
+#endif
+}
+
+/**
+ * @brief Edges delivered to the handlers when several arrive between two ticks
+ */
+static void benchInterruptBurst(int burst) {
+#if defined(ASYNC_HOST) || defined(BENCH_PIN_OUT)
+    Executor executor;
+    Pin * input = new Pin(BENCH_PIN_IN, INPUT_PULLUP);
+    executor.start();
+    executor.add(input);
+
+    uint32_t rising = 0, falling = 0;
+    input->onInterrupt(RISING, [&]() { rising++; });
+    input->onInterrupt(FALLING, [&]() { falling++; });
+
+    const int rounds = 100;
+
+    for(int i=0; i < rounds; i++) {
+        for(int j=0; j < burst; j++) {
+        #if defined(ASYNC_HOST)
+            host::setPin(BENCH_PIN_IN, j % 2 == 0 ? LOW : HIGH);
+        #else
+            digitalWrite(BENCH_PIN_OUT, j % 2 == 0 ? LOW : HIGH);
+        #endif
+        }
+
+        executor.tick();
+    }
+
+    Serial.printf("BENCH name=isr_burst burst=%d edges=%d rising=%u falling=%u overflows=%u\n",
+        burst, rounds * burst, rising, falling, input->getOverflows());
+#else
+    Serial.println("BENCH name=isr_burst skipped=1");
+#endif
+}
+
+void setup() {
+    Serial.begin(115200);
+
+#if defined(BENCH_PIN_OUT)
+    pinMode(BENCH_PIN_OUT, OUTPUT);
+    digitalWrite(BENCH_PIN_OUT, HIGH);
+#endif
+
+    const int modes[] = { Executor::POLL, Executor::TIMERS };
+
+    for(int mode : modes) {
+        for(int tasks : { 0, 10, 100, 1000 }) {
+            benchEmptyTick(mode, tasks);
+        }
+    }
+
+    for(int mode : modes) {
+        benchRepeatJitter(mode, 1000, 0);
+        benchRepeatJitter(mode, 1000, 500);
+        benchRepeatJitter(mode, 1000, 500, Task::CATCH_UP);
+        benchRepeatJitter(mode, 200, 0, Task::CATCH_UP);
+    }
+
+    benchPriority(false, 0);
+    benchPriority(true, 0);
+    benchPriority(true, 500);
+
+    for(int mode : modes) {
+        benchChurn(mode, 0);
+        benchChurn(mode, 1000);
+    }
+
+    benchChainSteps(1);
+    benchChainSteps(16);
+
+    benchInterruptLatency();
+    benchInterruptBurst(2);
+    benchInterruptBurst(16);
+
+    Serial.println("BENCH done=1");
+}
+
+void loop() {
+#if defined(ASYNC_HOST)
+    exit(0);
+#endif
+}
@@ -0,0 +1,46 @@
+#include <async/Log.h>
+#include <async/Executor.h>
+#include <async/Channel.h>
+
+using namespace async;
+
+struct Sample {
+  uint32_t time;
+  int level;
+};
+
+Executor executor;
+
+// Keeps the newest 64 samples if the consumer falls behind
+Channel<Sample, 64> samples(ChannelPolicy::DROP_OLDEST);
+
+IRAM_ATTR void onEdge(void *) {
+  samples.send({ (uint32_t) micros(), digitalRead(4) });
+}
+
+void setup() {
+  Serial.begin(115200);
+  executor.start();
+
+  // Parked until the first sample arrives, then reads the whole burst at once
+  samples.setConsumer(executor.onDemand([]() {
+    size_t count = samples.drain([](const Sample & sample) {
+      info("level %d at %u us", sample.level, (unsigned) sample.time);
+    });
+
+    info("batch of %d, %u dropped so far", (int) count, (unsigned) samples.getDropped());
+  }));
+
+  // Producers: an interrupt and a task
+  pinMode(4, INPUT_PULLUP);
+  attachInterruptArg(4, onEdge, nullptr, CHANGE);
+
+  executor.onRepeat(1000, []() {
+    samples.send({ (uint32_t) micros(), -1 });
+  });
+}
+
+void loop() {
+  executor.tick();
+  executor.sleep();
+}
@@ -0,0 +1,67 @@
+#include <async/Log.h>
+#include <async/Executor.h>
+#include <async/Coroutine.h>
+
+// Needs a C++20 compiler with coroutine support (e.g. GCC 11+ with -std=c++20)
+#if defined(__cpp_impl_coroutine)
+
+using namespace async;
+
+Executor executor;
+Pin button(4, INPUT_PULLUP);
+Semaphore bus(1, 1);
+
+co_task<int> measure(int channel) {
+  co_await bus;
+  co_await co::delay(20);       // conversion time
+  bus.release();
+  co_return channel * 100;
+}
+
+co_task<void> sampler() {
+  for(int i = 0; i < 5; i++) {
+    int value = co_await measure(i);
+    info("sample %d = %d", i, value);
+    co_await co::delay(1000);
+  }
+
+  info("sampling done");
+}
+
+co_task<void> waitForButton() {
+  while(true) {
+    // Await into a variable: GCC 12 skips the coroutine body for co_await in an if()
+    bool pressed = co_await button.edge(FALLING, 3000);
+
+    if(pressed) {
+      info("button pressed");
+    }
+    else {
+      info("no press within 3 s");
+    }
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  executor.start();
+  button.setOwned(false);
+  executor.add(&button);
+  executor.add(spawn(sampler()));
+  executor.add(spawn(waitForButton()));
+}
+
+void loop() {
+  executor.tick();
+}
+
+#else
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("Coroutine example needs C++20 coroutines");
+}
+
+void loop() {}
+
+#endif
@@ -10,6 +10,7 @@ Executor executor;
 
 void setup() {
   Serial.begin(115200); 
+  executor.start();
  
   Duration * repeatTask1Duration = new Duration(1000);
   auto repeatTask1 = new Task(Task::REPEAT, repeatTask1Duration, [repeatTask1Duration]() {
@@ -15,6 +15,10 @@ void setup() {
   info("info message %d", millis());
   warn("warn message %d", millis());
   error("error message %d", millis());
+
+  // with ASYNC_LOG_DEFERRED the lines above are only queued, print them now
+  // (or add Log::drainTask() to an executor to print them in the background)
+  Log::drain();
 }
 
 void loop() {}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include <async/Log.h>
+#include <async/MultiExecutor.h>
+
+using namespace async;
+
+// worker 0 runs in loop(), worker 1 in its own task on the other core
+MultiExecutor executor(2);
+
+float fused = 0;
+
+void setup() {
+  Serial.begin(115200);
+  executor.start();
+
+  // control loop stays on the loop() worker
+  executor.onRepeat(10, []() {
+    fused = fused * 0.9f;
+  }, 0);
+
+  // CPU heavy jobs may run on whichever worker is free
+  for(int i=0; i < 4; i++) {
+    executor.onRepeat(50, [i]() {
+      float sum = 0;
+      for(int j=0; j < 20000; j++) {
+        sum += (j % 7) * 0.001f;
+      }
+      fused += sum;
+    });
+  }
+
+  executor.onRepeat(1000, []() {
+    info("worker queues %d/%d, steals %u", (int) executor.size(0), (int) executor.size(1), executor.steals());
+  }, 0);
+}
+
+void loop() {
+  executor.tick();
+}
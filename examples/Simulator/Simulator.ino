@@ -0,0 +1,64 @@
+#include <async/Executor.h>
+#include <async/Chain.h>
+#include <async/Pin.h>
+#include <async/Simulator.h>
+#include <chrono>
+
+// Host only: simulates one week of a device in virtual time and checks the schedule
+
+using namespace async;
+
+static const uint64_t MINUTE = 60ULL * 1000000;
+static const uint64_t HOUR = 60 * MINUTE;
+static const uint64_t DAY = 24 * HOUR;
+
+Executor executor(Executor::TIMERS);
+
+void setup() {
+  Serial.begin(115200);
+  executor.start();
+
+  Simulator sim(executor);
+  int hourly = 0;
+
+  // Sensor reading every hour
+  executor.onRepeat(Duration::us(HOUR), [&]() {
+    hourly++;
+  });
+
+  // Daily watering: valve open for one minute, then wait until the next day
+  Chain<> * watering = (new Chain<>())
+    ->delay(Duration::us(DAY - MINUTE))
+    ->then([&]() { sim.mark("valve on"); })
+    ->delay(Duration::us(MINUTE))
+    ->then([&]() { sim.mark("valve off"); })
+    ->loop();
+  executor.add(watering);
+
+  // A button press on the third day
+  Pin * button = new Pin(4, INPUT);
+  button->onInterrupt(RISING, [&]() { sim.mark("button"); });
+  executor.add(button);
+  sim.pulse(2 * DAY + 12 * HOUR, 4, 50000);
+
+  auto started = std::chrono::steady_clock::now();
+  uint32_t passes = sim.runFor(7 * DAY);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+  std::vector<Simulator::Mark> expected;
+  for(int day = 0; day < 7; day++) {
+    if(day == 2) {
+      expected.push_back({ 2 * DAY + 12 * HOUR, "button" });
+    }
+    expected.push_back({ (day + 1) * DAY - MINUTE, "valve on" });
+    expected.push_back({ (day + 1) * DAY, "valve off" });
+  }
+
+  bool ok = sim.expect(expected, 1000) && hourly == 7 * 24;
+
+  printf("simulated 7 days in %.3f s, %u passes, %d hourly runs, %zu marks: %s\n",
+    elapsed.count(), passes, hourly, sim.marks().size(), ok ? "ok" : "FAILED");
+  exit(ok ? 0 : 1);
+}
+
+void loop() {}
@@ -0,0 +1,32 @@
+#include <async/Log.h>
+#include <async/Executor.h>
+#include <async/Pin.h>
+
+using namespace async;
+
+Executor executor(Executor::TIMERS);
+Pin button(23, INPUT_PULLUP);
+
+void setup() {
+  Serial.begin(115200);
+  executor.start();
+  button.setOwned(false);
+  executor.add(&button);
+
+  // use light sleep for idle periods of 100 ms or more
+  Sleep::setLightSleep(100);
+
+  executor.onRepeat(5000, []() {
+    info("Repeat task, next wake up in %d ms", (int) executor.idleTime());
+  });
+
+  // the ISR demand() wakes the loop immediately
+  button.onInterrupt(FALLING, []() {
+    info("Button pressed");
+  });
+}
+
+void loop() {
+  executor.tick();
+  executor.sleep();
+}
@@ -9,6 +9,7 @@ Executor executor;
 
 void setup() {
   Serial.begin(115200); 
+  executor.start();
   info("Boot");
 
   executor.add(counter.onChange([](int current, int prev) {
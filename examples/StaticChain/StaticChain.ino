@@ -0,0 +1,39 @@
+#include <async/Log.h>
+#include <async/Executor.h>
+#include <async/StaticChain.h>
+
+using namespace async;
+
+Executor executor;
+Pin button(4, INPUT_PULLUP);
+Semaphore bus(1, 1);
+
+// Blink without allocations: steps and their storage are fixed at compile time
+auto blink = makeChain(
+  step::then([]() { digitalWrite(LED_BUILTIN, HIGH); }),
+  step::delay(100),
+  step::then([]() { digitalWrite(LED_BUILTIN, LOW); }),
+  step::delay(900));
+
+// Report a button press, or its absence within 5 s, while holding the bus
+auto report = makeChain(
+  step::edge(&button, FALLING, 5000),
+  step::acquire(&bus),
+  step::then([]() { info("button checked"); }),
+  step::delay(20),
+  step::then([]() { bus.release(); }));
+
+void setup() {
+  Serial.begin(115200);
+  pinMode(LED_BUILTIN, OUTPUT);
+  executor.start();
+  button.setOwned(false);
+  executor.add(&button);
+  executor.add(&blink.loop());
+  executor.add(&report.loop());
+  info("blink chain: %d bytes", (int) sizeof(blink));
+}
+
+void loop() {
+  executor.tick();
+}
@@ -0,0 +1,31 @@
+#include <async/Log.h>
+#include <async/Executor.h>
+
+// needs the build flag -D ASYNC_STATS=1, e.g. in platformio.ini or cmake -DASYNC_STATS=ON
+
+using namespace async;
+
+Executor executor(Executor::TIMERS);
+
+void setup() {
+  Serial.begin(115200);
+  executor.start();
+
+  executor.onRepeat(10, []() {
+    delayMicroseconds(200);
+  })->setName("control");
+
+  executor.onRepeat(100, []() {
+    delayMicroseconds(3000);
+  })->setName("fusion");
+
+  executor.onRepeat(5000, []() {
+    executor.report(Serial);
+    executor.resetStats();
+  })->setName("report");
+}
+
+void loop() {
+  executor.tick();
+  executor.sleep();
+}
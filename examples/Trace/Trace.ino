@@ -0,0 +1,49 @@
+#include <async/Executor.h>
+#include <async/Chain.h>
+#include <async/State.h>
+#include <async/Trace.h>
+
+// needs the build flag -D ASYNC_TRACE=1, e.g. in platformio.ini or cmake -DASYNC_TRACE=ON
+// save the output as trace.json and open it in chrome://tracing or ui.perfetto.dev
+
+using namespace async;
+
+Executor executor(Executor::TIMERS);
+State<int> counter(0);
+
+void setup() {
+  Serial.begin(115200);
+  executor.start();
+  counter.setOwned(false);
+  executor.add(&counter);
+  counter.setName("counter");
+
+  counter.onChange([](int current, int previous) {
+    delayMicroseconds(100);
+  });
+
+  executor.onRepeat(20, []() {
+    counter.set(counter.get() + 1);
+  })->setName("increment");
+
+  auto chain = new Chain<>();
+  chain->delay(5)
+    ->then([]() { delayMicroseconds(300); })
+    ->delay(Duration::us(2500))
+    ->then([]() { delayMicroseconds(50); })
+    ->loop();
+  chain->setName("blink");
+  executor.add(chain);
+
+  executor.onDelay(200, []() {
+    Trace::dump(Serial);
+#if defined(ASYNC_HOST)
+    exit(0);
+#endif
+  });
+}
+
+void loop() {
+  executor.tick();
+  executor.sleep();
+}
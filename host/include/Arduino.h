@@ -0,0 +1,224 @@
+#pragma once
+
+/**
+ * @file Arduino.h
+ * @brief Minimal Arduino/ESP32 API for building the library on a host
+ *
+ * @details Only the parts of the Arduino core used by the library are provided.
+ * Time comes from a controllable clock: by default it follows the host's monotonic
+ * clock, in virtual mode it only moves when host::advanceMicros() or delay() is called.
+ * The same clock backs async::Clock::set()/advance() and the virtual Clock backend.
+ * millis() and micros() are truncated to 32 bits like on the ESP32, so wraparound can
+ * be reproduced by setting the clock close to 2^32.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT         0x01
+#define OUTPUT        0x03
+#define PULLUP        0x04
+#define INPUT_PULLUP  0x05
+#define PULLDOWN      0x08
+#define INPUT_PULLDOWN 0x09
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#define LED_BUILTIN 2
+
+#define IRAM_ATTR
+
+#define bit(b) (1ULL << (b))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+using std::min;
+using std::max;
+
+///@name Time
+///@{
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+///@}
+
+///@name GPIO
+///@{
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+uint16_t analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+void attachInterruptArg(uint8_t pin, void (*isr)(void *), void * arg, int mode);
+void detachInterrupt(uint8_t pin);
+inline int digitalPinToInterrupt(int pin) { return pin; }
+///@}
+
+///@name ESP32
+///@{
+int xPortGetCoreID();
+///@}
+
+///@name Random
+///@{
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+///@}
+
+/**
+ * @class String
+ * @brief Subset of the Arduino String class backed by std::string
+ */
+class String {
+    private:
+        std::string value;
+
+    public:
+        String() {}
+        String(const char * str) : value(str != nullptr ? str : "") {}
+        String(const std::string & str) : value(str) {}
+        String(char c) : value(1, c) {}
+        String(int num) : value(std::to_string(num)) {}
+        String(unsigned int num) : value(std::to_string(num)) {}
+        String(long num) : value(std::to_string(num)) {}
+        String(unsigned long num) : value(std::to_string(num)) {}
+        String(long long num) : value(std::to_string(num)) {}
+        String(unsigned long long num) : value(std::to_string(num)) {}
+        String(double num, unsigned int decimals = 2);
+
+        const char * c_str() const { return value.c_str(); }
+        unsigned int length() const { return value.length(); }
+        char charAt(unsigned int index) const { return index < value.length() ? value[index] : 0; }
+        char operator[](unsigned int index) const { return charAt(index); }
+        int indexOf(char c, unsigned int from = 0) const;
+        int indexOf(const String & str, unsigned int from = 0) const;
+        String substring(unsigned int from) const;
+        String substring(unsigned int from, unsigned int to) const;
+        long toInt() const { return atol(value.c_str()); }
+        float toFloat() const { return (float) atof(value.c_str()); }
+        bool isEmpty() const { return value.empty(); }
+
+        bool concat(const String & str) { value += str.value; return true; }
+        String & operator+=(const String & str) { value += str.value; return *this; }
+        friend String operator+(const String & left, const String & right) { return String(left.value + right.value); }
+
+        bool operator==(const String & other) const { return value == other.value; }
+        bool operator!=(const String & other) const { return value != other.value; }
+        bool operator<(const String & other) const { return value < other.value; }
+        bool equals(const String & other) const { return value == other.value; }
+};
+
+/**
+ * @class Print
+ * @brief Subset of the Arduino Print interface
+ */
+class Print {
+    public:
+        virtual ~Print() = default;
+        virtual size_t write(uint8_t c) = 0;
+        virtual size_t write(const uint8_t * buffer, size_t size);
+
+        size_t write(const char * str) { return str == nullptr ? 0 : write((const uint8_t *) str, strlen(str)); }
+        size_t print(const char * str) { return write(str); }
+        size_t print(const String & str) { return write(str.c_str()); }
+        size_t print(char c) { return write((uint8_t) c); }
+        size_t print(int num) { return print(String(num)); }
+        size_t print(unsigned int num) { return print(String(num)); }
+        size_t print(long num) { return print(String(num)); }
+        size_t print(unsigned long num) { return print(String(num)); }
+        size_t print(long long num) { return print(String(num)); }
+        size_t print(unsigned long long num) { return print(String(num)); }
+        size_t print(double num, int decimals = 2) { return print(String(num, decimals)); }
+        size_t println() { return write("\n"); }
+
+        template<typename T>
+        size_t println(const T & value) { size_t n = print(value); return n + println(); }
+
+        size_t printf(const char * format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+/**
+ * @class HardwareSerial
+ * @brief Serial port writing to the host's standard output
+ */
+class HardwareSerial : public Print {
+    public:
+        void begin(unsigned long) {}
+        void end() {}
+        int available() { return 0; }
+        int read() { return -1; }
+        void flush();
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t * buffer, size_t size) override;
+        using Print::write;
+        operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+/**
+ * @brief Host-only controls for the shim
+ */
+namespace host {
+    /**
+     * @brief Switch between the host monotonic clock and the virtual clock
+     * @param enabled True to only move time through advanceMicros()/delay()
+     *
+     * @note The current time is kept when switching. With the virtual Clock backend
+     * (ASYNC_CLOCK=3) the clock is always virtual.
+     */
+    void useVirtualClock(bool enabled = true);
+
+    /**
+     * @brief Check whether the virtual clock is active
+     */
+    bool isVirtualClock();
+
+    /**
+     * @brief Get the full 64-bit clock value behind millis()/micros()
+     * @return uint64_t Microseconds since start
+     */
+    uint64_t clockMicros();
+
+    /**
+     * @brief Set the clock
+     * @param us Microseconds since start
+     */
+    void setMicros(uint64_t us);
+
+    /**
+     * @brief Move the clock forward
+     * @param us Microseconds to add
+     */
+    void advanceMicros(uint64_t us);
+
+    /**
+     * @brief Drive an input level and run attached interrupt handlers like the hardware would
+     * @param pin Pin number
+     * @param level HIGH or LOW
+     */
+    void setPin(uint8_t pin, int level);
+
+    /**
+     * @brief Redirect Serial output
+     * @param file Output stream, nullptr discards the output
+     */
+    void setSerialOutput(FILE * file);
+}
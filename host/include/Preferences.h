@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+
+/**
+ * @file Preferences.h
+ * @brief In-memory replacement for the ESP32 Preferences (NVS) library
+ *
+ * @details Values are kept per namespace for the lifetime of the process.
+ */
+class Preferences {
+    private:
+        String name;
+        bool readOnly = false;
+        bool opened = false;
+
+    public:
+        bool begin(const char * name, bool readOnly = false);
+        void end();
+        bool clear();
+        bool remove(const char * key);
+        bool isKey(const char * key);
+
+        size_t putInt(const char * key, int32_t value);
+        size_t putFloat(const char * key, float value);
+        size_t putDouble(const char * key, double value);
+        size_t putBool(const char * key, bool value);
+        size_t putString(const char * key, String value);
+
+        int32_t getInt(const char * key, int32_t defaultValue = 0);
+        float getFloat(const char * key, float defaultValue = NAN);
+        double getDouble(const char * key, double defaultValue = NAN);
+        bool getBool(const char * key, bool defaultValue = false);
+        String getString(const char * key, String defaultValue = String());
+};
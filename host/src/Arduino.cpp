@@ -0,0 +1,269 @@
+#include <Arduino.h>
+#include <async/Clock.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+HardwareSerial Serial;
+
+namespace {
+    struct Interrupt {
+        void (*isr)(void *) = nullptr;
+        void * arg = nullptr;
+        int mode = 0;
+    };
+
+    const int PINS = 64;
+
+    // The virtual Clock backend reads this clock, so it starts and stays virtual there
+    bool const virtualOnly = ASYNC_CLOCK == ASYNC_CLOCK_VIRTUAL;
+    std::atomic<bool> virtualClock(virtualOnly);
+    std::atomic<uint64_t> virtualMicros(0);
+    std::atomic<int64_t> realOffset(0);
+    std::chrono::steady_clock::time_point realStart = std::chrono::steady_clock::now();
+
+    int levels[PINS];
+    uint16_t analogLevels[PINS];
+    Interrupt interrupts[PINS];
+    FILE * serialOutput = stdout;
+    std::mutex serialMutex;
+    std::mt19937 generator;
+
+    uint64_t realMicros() {
+        auto elapsed = std::chrono::steady_clock::now() - realStart;
+        return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() + realOffset.load();
+    }
+}
+
+uint64_t host::clockMicros() {
+    return virtualClock.load() ? virtualMicros.load() : realMicros();
+}
+
+void host::useVirtualClock(bool enabled) {
+    uint64_t now = clockMicros();
+    virtualMicros.store(now);
+    realOffset.store(0);
+    realOffset.store((int64_t) now - (int64_t) realMicros());
+    virtualClock.store(enabled || virtualOnly);
+}
+
+bool host::isVirtualClock() {
+    return virtualClock.load();
+}
+
+void host::setMicros(uint64_t us) {
+    if(virtualClock.load()) {
+        virtualMicros.store(us);
+    }
+    else {
+        realOffset.store(0);
+        realOffset.store((int64_t) us - (int64_t) realMicros());
+    }
+}
+
+void host::advanceMicros(uint64_t us) {
+    if(virtualClock.load()) {
+        virtualMicros.fetch_add(us);
+    }
+    else {
+        realOffset.fetch_add(us);
+    }
+}
+
+void host::setPin(uint8_t pin, int level) {
+    if(pin >= PINS) {
+        return;
+    }
+
+    int previous = levels[pin];
+    levels[pin] = level ? HIGH : LOW;
+
+    Interrupt & interrupt = interrupts[pin];
+
+    if(interrupt.isr == nullptr || previous == levels[pin]) {
+        return;
+    }
+
+    if(interrupt.mode == CHANGE || 
+      (interrupt.mode == RISING && levels[pin] == HIGH) || 
+      (interrupt.mode == FALLING && levels[pin] == LOW)) {
+        interrupt.isr(interrupt.arg);
+    }
+}
+
+void host::setSerialOutput(FILE * file) {
+    std::lock_guard<std::mutex> lock(serialMutex);
+    serialOutput = file;
+}
+
+unsigned long millis() {
+    return (uint32_t) (host::clockMicros() / 1000);
+}
+
+unsigned long micros() {
+    return (uint32_t) host::clockMicros();
+}
+
+void delay(uint32_t ms) {
+    if(virtualClock.load()) {
+        virtualMicros.fetch_add(ms * 1000ULL);
+    }
+    else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+}
+
+void delayMicroseconds(uint32_t us) {
+    if(virtualClock.load()) {
+        virtualMicros.fetch_add(us);
+    }
+    else {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+void yield() {
+    if(!virtualClock.load()) {
+        std::this_thread::yield();
+    }
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if(pin < PINS && mode == INPUT_PULLUP) {
+        levels[pin] = HIGH;
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < PINS ? levels[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if(pin < PINS) {
+        levels[pin] = val ? HIGH : LOW;
+    }
+}
+
+uint16_t analogRead(uint8_t pin) {
+    return pin < PINS ? analogLevels[pin] : 0;
+}
+
+void analogWrite(uint8_t pin, int value) {
+    if(pin < PINS) {
+        analogLevels[pin] = value;
+    }
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void *), void * arg, int mode) {
+    if(pin < PINS) {
+        interrupts[pin].isr = isr;
+        interrupts[pin].arg = arg;
+        interrupts[pin].mode = mode;
+    }
+}
+
+void detachInterrupt(uint8_t pin) {
+    if(pin < PINS) {
+        interrupts[pin] = Interrupt();
+    }
+}
+
+int xPortGetCoreID() {
+    return 0;
+}
+
+long random(long max) {
+    return max <= 0 ? 0 : random(0, max);
+}
+
+long random(long min, long max) {
+    if(min >= max) {
+        return min;
+    }
+
+    return std::uniform_int_distribution<long>(min, max - 1)(generator);
+}
+
+void randomSeed(unsigned long seed) {
+    generator.seed(seed);
+}
+
+String::String(double num, unsigned int decimals) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, num);
+    value = buffer;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t index = value.find(c, from);
+    return index == std::string::npos ? -1 : (int) index;
+}
+
+int String::indexOf(const String & str, unsigned int from) const {
+    size_t index = value.find(str.value, from);
+    return index == std::string::npos ? -1 : (int) index;
+}
+
+String String::substring(unsigned int from) const {
+    return from < value.length() ? String(value.substr(from)) : String();
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if(from > to) {
+        std::swap(from, to);
+    }
+
+    return from < value.length() ? String(value.substr(from, to - from)) : String();
+}
+
+size_t Print::write(const uint8_t * buffer, size_t size) {
+    size_t written = 0;
+
+    while(written < size && write(buffer[written])) {
+        written++;
+    }
+
+    return written;
+}
+
+size_t Print::printf(const char * format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    if(length < 0) {
+        return 0;
+    }
+
+    return write((const uint8_t *) buffer, min((size_t) length, sizeof(buffer) - 1));
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t * buffer, size_t size) {
+    std::lock_guard<std::mutex> lock(serialMutex);
+
+    if(serialOutput != nullptr) {
+        fwrite(buffer, 1, size, serialOutput);
+
+        if(memchr(buffer, '\n', size) != nullptr) {
+            fflush(serialOutput);
+        }
+    }
+
+    return size;
+}
+
+void HardwareSerial::flush() {
+    std::lock_guard<std::mutex> lock(serialMutex);
+
+    if(serialOutput != nullptr) {
+        fflush(serialOutput);
+    }
+}
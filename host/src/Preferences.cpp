@@ -0,0 +1,120 @@
+#include <Preferences.h>
+#include <map>
+#include <mutex>
+
+namespace {
+    std::map<std::string, std::map<std::string, std::string>> storage;
+    std::mutex storageMutex;
+
+    std::string & slot(const String & name, const char * key) {
+        return storage[name.c_str()][key];
+    }
+
+    bool find(const String & name, const char * key, std::string & value) {
+        auto space = storage.find(name.c_str());
+
+        if(space == storage.end()) {
+            return false;
+        }
+
+        auto entry = space->second.find(key);
+
+        if(entry == space->second.end()) {
+            return false;
+        }
+
+        value = entry->second;
+        return true;
+    }
+}
+
+bool Preferences::begin(const char * name, bool readOnly) {
+    this->name = name;
+    this->readOnly = readOnly;
+    this->opened = true;
+    return true;
+}
+
+void Preferences::end() {
+    this->opened = false;
+}
+
+bool Preferences::clear() {
+    std::lock_guard<std::mutex> lock(storageMutex);
+
+    if(readOnly) {
+        return false;
+    }
+
+    storage.erase(name.c_str());
+    return true;
+}
+
+bool Preferences::remove(const char * key) {
+    std::lock_guard<std::mutex> lock(storageMutex);
+    auto space = storage.find(name.c_str());
+    return space != storage.end() && space->second.erase(key) > 0;
+}
+
+bool Preferences::isKey(const char * key) {
+    std::lock_guard<std::mutex> lock(storageMutex);
+    std::string value;
+    return find(name, key, value);
+}
+
+size_t Preferences::putInt(const char * key, int32_t value) {
+    return putString(key, String(std::to_string(value)));
+}
+
+size_t Preferences::putFloat(const char * key, float value) {
+    return putDouble(key, value);
+}
+
+size_t Preferences::putDouble(const char * key, double value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.17g", value);
+    return putString(key, String(buffer));
+}
+
+size_t Preferences::putBool(const char * key, bool value) {
+    return putString(key, String(value ? "1" : "0"));
+}
+
+size_t Preferences::putString(const char * key, String value) {
+    std::lock_guard<std::mutex> lock(storageMutex);
+
+    if(readOnly) {
+        return 0;
+    }
+
+    slot(name, key) = value.c_str();
+    return value.length();
+}
+
+int32_t Preferences::getInt(const char * key, int32_t defaultValue) {
+    std::lock_guard<std::mutex> lock(storageMutex);
+    std::string value;
+    return find(name, key, value) ? (int32_t) atol(value.c_str()) : defaultValue;
+}
+
+float Preferences::getFloat(const char * key, float defaultValue) {
+    return (float) getDouble(key, defaultValue);
+}
+
+double Preferences::getDouble(const char * key, double defaultValue) {
+    std::lock_guard<std::mutex> lock(storageMutex);
+    std::string value;
+    return find(name, key, value) ? atof(value.c_str()) : defaultValue;
+}
+
+bool Preferences::getBool(const char * key, bool defaultValue) {
+    std::lock_guard<std::mutex> lock(storageMutex);
+    std::string value;
+    return find(name, key, value) ? value == "1" : defaultValue;
+}
+
+String Preferences::getString(const char * key, String defaultValue) {
+    std::lock_guard<std::mutex> lock(storageMutex);
+    std::string value;
+    return find(name, key, value) ? String(value) : defaultValue;
+}
@@ -0,0 +1,17 @@
+#include <Arduino.h>
+
+/**
+ * @file sketch.cpp
+ * @brief Entry point running an Arduino sketch on the host
+ */
+
+void setup();
+void loop();
+
+int main() {
+    setup();
+
+    while(true) {
+        loop();
+    }
+}
@@ -1,6 +1,6 @@
 #pragma once
-#include <functional>
+#include <async/InplaceFunction.h>
 
 namespace async {
-    typedef std::function<void()> VoidCallback;
-}
\ No newline at end of file
+    typedef InplaceFunction<void()> VoidCallback;
+}
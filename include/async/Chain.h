@@ -6,6 +6,10 @@
 #include <async/Pin.h>
 #include <async/Callbacks.h>
 #include <async/Semaphore.h>
+#include <async/Config.h>
+#include <async/Pool.h>
+#include <async/Trace.h>
+#include <vector>
 
 namespace async {
     template<typename T = void>
@@ -14,26 +18,70 @@ namespace async {
     // Специализация для void
     template<>
     class Chain<void> : public Tick {
+        public:
+            typedef InplaceFunction<Tick *()> TickFactory;
+
         private:
-            enum class OpType { DELAY, THEN, SEMAPHORE_WAIT, SEMAPHORE_SKIP, INTERR, LOOP };
+            enum class OpType { DELAY, THEN, SEMAPHORE_WAIT, SEMAPHORE_SKIP, INTERR, LOOP, AWAIT };
             
             struct Operation {
                 OpType type;
                 VoidCallback callback;
-                unsigned long delay;
-                unsigned long timeout;
+                TickFactory factory; ///< Creates the Tick an AWAIT step runs
+                uint64_t delay;   ///< DELAY step length in microseconds
+                uint64_t timeout; ///< INTERR timeout in microseconds
                 Semaphore * semaphore;
                 Pin * pin;
+
+#if ASYNC_OPERATION_POOL_SIZE > 0
+                ASYNC_POOLED(Operation, ASYNC_OPERATION_POOL_SIZE)
+#endif
             };
         
             std::vector<Operation*> operations;
             uint8_t operationCount;
             uint8_t currentOpIndex;
-            unsigned long delayStart;
+            uint64_t delayStart;
             volatile bool interruptTriggered;
             Operation * interruptOperation;
+            Tick * awaited = nullptr; ///< Tick of the running AWAIT step
+            WakeQueue awaitWakes; ///< Routes the awaited Tick's wake() calls to the chain
+            Semaphore * waitingOn = nullptr; ///< Semaphore the chain is registered with
             bool shouldLoop = false;
             bool cancelled = false;
+
+            /**
+             * @brief Cancel and delete the Tick of a running AWAIT step
+             */
+            void dropAwaited() {
+                if(awaited != nullptr) {
+                    awaited->cancel();
+                    releaseAwaited();
+                }
+            }
+
+            /**
+             * @brief Stop routing the awaited Tick's wake() calls and delete it if owned
+             */
+            void releaseAwaited() {
+                awaitWakes.detach(awaited);
+
+                if(awaited->isOwned()) {
+                    delete awaited;
+                }
+
+                awaited = nullptr;
+            }
+
+            /**
+             * @brief Unregister from the semaphore of a SEMAPHORE_WAIT step
+             */
+            void stopWaiting() {
+                if(waitingOn != nullptr) {
+                    waitingOn->forget(this);
+                    waitingOn = nullptr;
+                }
+            }
         
             void addOperation(Operation * op) {
                 operations.push_back(op);
@@ -42,7 +90,7 @@ namespace async {
         
             void resetChain() {
                 currentOpIndex = 0;
-                delayStart = 0;
+                delayStart = uptimeMicros();
                 interruptTriggered = false;
                 interruptOperation = nullptr;
             }
@@ -50,9 +98,12 @@ namespace async {
         public:
             Chain() : operationCount(0), 
                       currentOpIndex(0), delayStart(0), interruptTriggered(false),
-                      interruptOperation(nullptr) {}
+                      interruptOperation(nullptr), awaitWakes(this) {}
         
             ~Chain() {
+                dropAwaited();
+                stopWaiting();
+
                 for(int i=0; i < operations.size(); i++) {
                     delete operations[i];
                 }
@@ -61,7 +112,19 @@ namespace async {
             Chain * delay(unsigned long ms) {
                 auto op = new Operation();
                 op->type = OpType::DELAY;
-                op->delay = ms;
+                op->delay = (uint64_t) ms * 1000;
+                addOperation(op);
+                return this;
+            }
+
+            /**
+             * @brief Wait before the next step, with microsecond resolution
+             * @param duration Step length, e.g. Duration::us(250)
+             */
+            Chain * delay(Duration duration) {
+                auto op = new Operation();
+                op->type = OpType::DELAY;
+                op->delay = duration.get(Duration::MICRO);
                 addOperation(op);
                 return this;
             }
@@ -69,7 +132,7 @@ namespace async {
             Chain * then(VoidCallback callback) {
                 auto op = new Operation();
                 op->type = OpType::THEN;
-                op->callback = callback;
+                op->callback = std::move(callback);
                 addOperation(op);
                 return this;
             }
@@ -93,12 +156,13 @@ namespace async {
             Chain * interrupt(Pin * pin, int edge, unsigned long timeout = 0xFFFFFFFF) {
                 auto op = new Operation();
                 op->type = OpType::INTERR;
-                op->timeout = timeout;
+                op->timeout = (uint64_t) timeout * 1000;
                 op->pin = pin;
 
                 pin->onInterrupt(edge, [this, op]() {
                     if(this->interruptOperation == op) {
                         this->interruptTriggered = true;
+                        this->wake();
                     }
                 });
 
@@ -106,17 +170,99 @@ namespace async {
                 return this;
             }
         
+            /**
+             * @brief Run a Tick object until it is done, e.g. a race() or all() group
+             * @param factory Creates the Tick each time the step is reached; the chain
+             * starts, ticks and deletes it
+             */
+            Chain * await(TickFactory factory) {
+                auto op = new Operation();
+                op->type = OpType::AWAIT;
+                op->factory = std::move(factory);
+                addOperation(op);
+                return this;
+            }
+        
             Chain * loop() {
                 shouldLoop = true;
                 return this;
             }
 
+            bool start() override {
+                delayStart = uptimeMicros();
+                return true;
+            }
+
             bool cancel() {
                 cancelled = true;
+                dropAwaited();
+                stopWaiting();
                 return true;
             }
+
+            /**
+             * @brief Get the time at which the current step needs its next tick
+             * @return uint64_t Due time of a DELAY step or INTERR timeout, NEVER while a
+             * SEMAPHORE_WAIT step waits for a release, the deadline() of an awaited Tick,
+             * 0 otherwise
+             *
+             * @details Lets an executor keep the chain out of its polling list: timed
+             * steps wait in the timer queue (TIMERS mode), a semaphore wait stays parked
+             * until Semaphore::release(), an interrupt wait until its edge wakes it and an
+             * AWAIT step until the awaited Tick's deadline or wake().
+             */
+            uint64_t deadline() override {
+                if(cancelled || currentOpIndex >= operations.size()) {
+                    return 0;
+                }
+
+                Operation * op = operations.at(currentOpIndex);
+
+                if(op->type == OpType::DELAY) {
+                    return delayStart + op->delay;
+                }
+                else if(op->type == OpType::INTERR && interruptOperation == op && !interruptTriggered) {
+                    return delayStart + op->timeout;
+                }
+                else if(op->type == OpType::SEMAPHORE_WAIT && waitingOn == op->semaphore && !op->semaphore->ready(this)) {
+                    return NEVER;
+                }
+                else if(op->type == OpType::AWAIT && awaited != nullptr) {
+                    return awaited->deadline();
+                }
+
+                return 0;
+            }
+
+            /**
+             * @brief Get the time at which the current step may have work to do
+             * @return uint64_t deadline(), or the wakeTime() of an awaited Tick
+             */
+            uint64_t wakeTime() override {
+                if(!cancelled && currentOpIndex < operations.size() && operations.at(currentOpIndex)->type == OpType::AWAIT && awaited != nullptr) {
+                    return awaited->wakeTime();
+                }
+
+                return deadline();
+            }
         
-            bool tick() {
+            bool tick() override {
+                int step = currentOpIndex;
+                bool keep = advance();
+
+                if(currentOpIndex != step) {
+                    ASYNC_TRACE_EVENT(Trace::INSTANT, Trace::CHAIN_STEP, this, currentOpIndex);
+                }
+
+                return keep;
+            }
+
+        private:
+            /**
+             * @brief Run or poll the current step
+             * @return bool False once the chain has finished or was cancelled
+             */
+            bool advance() {
                 if(cancelled) return false;
 
                 if (currentOpIndex >= operations.size()) {
@@ -135,11 +281,14 @@ namespace async {
                 
                 switch (op->type) {
                     case OpType::SEMAPHORE_WAIT:
-                        if (!op->semaphore->tryAcquire()) {
-                            return true; // Продолжаем ждать
+                        if (!op->semaphore->tryAcquire(this)) {
+                            // Queued, release() wakes the chain when it is its turn
+                            waitingOn = op->semaphore;
+                            return true;
                         }
+                        waitingOn = nullptr;
                         currentOpIndex++;
-                        delayStart = millis();
+                        delayStart = uptimeMicros();
                         return true;
 
                     case OpType::SEMAPHORE_SKIP:
@@ -149,29 +298,29 @@ namespace async {
                         }
                         
                         currentOpIndex++;
-                        delayStart = millis();
+                        delayStart = uptimeMicros();
 
                         return true;
                         
                     case OpType::DELAY:
-                        if (millis() - delayStart < op->delay) {
+                        if (uptimeMicros() - delayStart < op->delay) {
                             return true;
                         }
-                        delayStart = millis();
+                        delayStart = uptimeMicros();
                         currentOpIndex++;
                         return true;
                         
                     case OpType::THEN:
                         op->callback();
                         currentOpIndex++;
-                        delayStart = millis();
+                        delayStart = uptimeMicros();
                         return true;
                         
                     case OpType::INTERR:
                         if(this->interruptOperation == nullptr) {
                             interruptOperation = op;
                             interruptTriggered = false;
-                            delayStart = millis();
+                            delayStart = uptimeMicros();
                         }
                         
                         if (interruptTriggered) {
@@ -180,12 +329,37 @@ namespace async {
                             return true;
                         }
                         
-                        if (millis() - delayStart >= op->timeout) {
+                        if (uptimeMicros() - delayStart >= op->timeout) {
                             this->interruptOperation = nullptr;
                             currentOpIndex++;
                             return true;
                         }
                         return true;
+
+                    case OpType::AWAIT:
+                        if(awaited == nullptr) {
+                            awaited = op->factory();
+
+                            if(awaited != nullptr) {
+                                awaitWakes.attach(awaited);
+                                awaited->start();
+                            }
+                        }
+
+                        // The awaited Tick is ticked below, the queue only carries the wakeup
+                        awaitWakes.drain([](Tick *) {});
+
+                        if(awaited != nullptr && awaited->tick()) {
+                            return true;
+                        }
+
+                        if(awaited != nullptr) {
+                            releaseAwaited();
+                        }
+
+                        currentOpIndex++;
+                        delayStart = uptimeMicros();
+                        return true;
                 }
         
                 return false;
@@ -196,42 +370,57 @@ namespace async {
     // Шаблонная версия для типизированных цепочек
     template<typename T>
     class Chain : public Tick {
-        typedef std::function<T(T)> TypedCallback;
-        typedef std::function<bool(T)> TypedAgainCallback;
+        typedef InplaceFunction<T(T)> TypedCallback;
+        typedef InplaceFunction<bool(T)> TypedAgainCallback;
 
         private:
         enum class OpType { DELAY, THEN, SEMAPHORE_WAIT, SEMAPHORE_SKIP, INTERR, LOOP, CYCLE, AGAIN };
         
         struct Operation {
             OpType type;
-            unsigned long delay;
-            unsigned long timeout;
+            uint64_t delay;   ///< DELAY step length in microseconds
+            uint64_t timeout; ///< INTERR timeout in microseconds
             TypedCallback callback;
             TypedAgainCallback againCallback;
             Semaphore * semaphore;
             Pin * pin;
+
+#if ASYNC_OPERATION_POOL_SIZE > 0
+            ASYNC_POOLED(Operation, ASYNC_OPERATION_POOL_SIZE)
+#endif
         };
     
         int operationCount;
         int operationCapacity;
         int currentOpIndex;
-        unsigned long delayStart;
+        uint64_t delayStart;
         Operation * interruptOperation;
         bool interruptTriggered;
         bool shouldLoop = false;
         bool cycleExitFlag = false;
         T value;
         std::vector<Operation *> operations;
+        Semaphore * waitingOn = nullptr; ///< Semaphore the chain is queued at
         bool cancelled = false;
     
         void addOperation(Operation * op) {
             operations.push_back(op);
             operationCount++;
         }
+
+        /**
+         * @brief Leave the queue of the semaphore of a SEMAPHORE_WAIT step
+         */
+        void stopWaiting() {
+            if(waitingOn != nullptr) {
+                waitingOn->forget(this);
+                waitingOn = nullptr;
+            }
+        }
     
         void resetChain() {
             currentOpIndex = 0;
-            delayStart = 0;
+            delayStart = uptimeMicros();
             interruptOperation = nullptr;
         }
     public:
@@ -239,6 +428,8 @@ namespace async {
                   currentOpIndex(0), delayStart(0), interruptTriggered(false), value(value), interruptOperation(nullptr) {}
     
         ~Chain() {
+            stopWaiting();
+
             for(int i=0; i < operations.size(); i++) {
                 delete operations[i];
             }
@@ -247,7 +438,19 @@ namespace async {
         Chain* delay(unsigned long ms) {
             auto op = new Operation();
             op->type = OpType::DELAY;
-            op->delay = ms;
+            op->delay = (uint64_t) ms * 1000;
+            addOperation(op);
+            return this;
+        }
+
+        /**
+         * @brief Wait before the next step, with microsecond resolution
+         * @param duration Step length, e.g. Duration::us(250)
+         */
+        Chain* delay(Duration duration) {
+            auto op = new Operation();
+            op->type = OpType::DELAY;
+            op->delay = duration.get(Duration::MICRO);
             addOperation(op);
             return this;
         }
@@ -255,7 +458,7 @@ namespace async {
         Chain* then(TypedCallback callback) {
             auto op = new Operation();
             op->type = OpType::THEN;
-            op->callback = callback;
+            op->callback = std::move(callback);
             addOperation(op);
             return this;
         }
@@ -263,7 +466,7 @@ namespace async {
         Chain* cycle(TypedCallback callback) {
             auto op = new Operation();
             op->type = OpType::CYCLE;
-            op->callback = callback;
+            op->callback = std::move(callback);
             addOperation(op);
             return this;
         }
@@ -271,7 +474,7 @@ namespace async {
         Chain* again(TypedAgainCallback callback) {
             auto op = new Operation();
             op->type = OpType::AGAIN;
-            op->againCallback = callback;
+            op->againCallback = std::move(callback);
             addOperation(op);
             return this;
         }
@@ -295,12 +498,13 @@ namespace async {
         Chain* interrupt(Pin * pin, int edge, unsigned long timeout = 0xFFFFFFFF) {
             auto op = new Operation();
             op->type = OpType::INTERR;
-            op->timeout = timeout;
+            op->timeout = (uint64_t) timeout * 1000;
             op->pin = pin;
 
             pin->onInterrupt(edge, [this, op]() {
                 if(this->interruptOperation == op) {
                     this->interruptTriggered = true;
+                    this->wake();
                 }
             });
             addOperation(op);
@@ -312,12 +516,59 @@ namespace async {
             return this;
         }
 
+        bool start() override {
+            delayStart = uptimeMicros();
+            return true;
+        }
+
         bool cancel() {
             cancelled = true;
+            stopWaiting();
             return true;
         }
+
+        /**
+         * @brief Get the time at which the current step needs its next tick
+         * @return uint64_t Due time of a DELAY step or INTERR timeout, NEVER while a
+         * SEMAPHORE_WAIT step is queued, 0 otherwise
+         */
+        uint64_t deadline() override {
+            if(cancelled || currentOpIndex >= operationCount) {
+                return 0;
+            }
+
+            Operation * op = operations.at(currentOpIndex);
+
+            if(op->type == OpType::DELAY) {
+                return delayStart + op->delay;
+            }
+            else if(op->type == OpType::INTERR && interruptOperation == op && !interruptTriggered) {
+                return delayStart + op->timeout;
+            }
+            else if(op->type == OpType::SEMAPHORE_WAIT && waitingOn == op->semaphore && !op->semaphore->ready(this)) {
+                return NEVER;
+            }
+
+            return 0;
+        }
     
-        bool tick() {
+        bool tick() override {
+            int step = currentOpIndex;
+            bool keep = advance();
+
+            if(currentOpIndex != step) {
+                ASYNC_TRACE_EVENT(Trace::INSTANT, Trace::CHAIN_STEP, this, currentOpIndex);
+            }
+
+            return keep;
+        }
+
+    private:
+        /**
+         * @brief Run or poll the current step
+         * @return bool False once the chain has finished or was cancelled
+         */
+        bool advance() {
             if(cancelled) return false;
 
             if (currentOpIndex >= operationCount) {
@@ -336,36 +587,39 @@ namespace async {
             
             switch (op->type) {
                 case OpType::SEMAPHORE_WAIT:
-                    if (!op->semaphore->acquire()) {
-                        return true; // Продолжаем ждать
+                    if (!op->semaphore->tryAcquire(this)) {
+                        // Queued, release() wakes the chain when it is its turn
+                        waitingOn = op->semaphore;
+                        return true;
                     }
+                    waitingOn = nullptr;
                     currentOpIndex++;
-                    delayStart = millis();
+                    delayStart = uptimeMicros();
                     return true;
 
                 case OpType::SEMAPHORE_SKIP:
-                    if (!op->semaphore->acquire()) {
+                    if (!op->semaphore->tryAcquire()) {
                         currentOpIndex = operations.size();
                         return true; // завершаем программу
                     }
                     
                     currentOpIndex++;
-                    delayStart = millis();
+                    delayStart = uptimeMicros();
 
                     return true;
                     
                 case OpType::DELAY:
-                    if (millis() - delayStart < op->delay) {
+                    if (uptimeMicros() - delayStart < op->delay) {
                         return true;
                     }
-                    delayStart = millis();
+                    delayStart = uptimeMicros();
                     currentOpIndex++;
                     return true;
                     
                 case OpType::THEN:
                     value = op->callback(value);
                     currentOpIndex++;
-                    delayStart = millis();
+                    delayStart = uptimeMicros();
                     return true;
                     
                 case OpType::AGAIN: {
@@ -382,7 +636,8 @@ namespace async {
                 case OpType::CYCLE: {
                     T result = op->callback(value);
 
-                    if(result == (T)nullptr) {
+                    // A value-initialized result, e.g. nullptr or 0, ends the cycle
+                    if(result == T()) {
                         currentOpIndex++;
                     }
                     else {
@@ -396,7 +651,7 @@ namespace async {
                     if(this->interruptOperation == nullptr) {
                         interruptOperation = op;
                         interruptTriggered = false;
-                        delayStart = millis();
+                        delayStart = uptimeMicros();
                     }
                     
                     if (interruptTriggered) {
@@ -405,7 +660,7 @@ namespace async {
                         return true;
                     }
                     
-                    if (millis() - delayStart >= op->timeout) {
+                    if (uptimeMicros() - delayStart >= op->timeout) {
                         this->interruptOperation = nullptr;
                         currentOpIndex++;
                         return true;
@@ -0,0 +1,217 @@
+#pragma once
+#include <async/MpscQueue.h>
+#include <async/Task.h>
+#include <async/CriticalSection.h>
+#include <atomic>
+
+/**
+ * @file Channel.h
+ * @brief Defines async::Channel, a bounded queue from ISRs, cores and tasks to one consumer Task.
+ */
+
+namespace async {
+    /**
+     * @brief Overflow policies of a Channel
+     */
+    class ChannelPolicy {
+        public:
+            static int const DROP_NEWEST = 0;  ///< A full channel rejects the new element
+            static int const DROP_OLDEST = 1;  ///< A full channel discards its oldest element
+            static int const BLOCK = 2;        ///< send() waits until the consumer made room
+    };
+
+    /**
+     * @class Channel
+     * @brief Typed bounded channel for many producers and one consumer Task
+     *
+     * @details Built on MpscQueue, so interrupts, the other core and executor tasks may
+     * send() concurrently without locks. The consumer is a DEMAND Task: the first send()
+     * after the consumer started reading demand()s it, later ones until the next drain()
+     * only store their element. A parked consumer costs the executor nothing until data
+     * arrives, and a burst is handled in one batch.
+     *
+     * @code
+     * Channel<Sample, 64> samples(Channel<Sample, 64>::DROP_OLDEST);
+     *
+     * samples.setConsumer(executor.onDemand([]() {
+     *     samples.drain([](const Sample & sample) { filter.add(sample); });
+     * }));
+     *
+     * void IRAM_ATTR onSample() { samples.send(readSample()); }
+     * @endcode
+     *
+     * Overflow policies:
+     * - DROP_NEWEST (default): send() returns false and the element is counted in
+     *   getDropped()
+     * - DROP_OLDEST: send() discards the oldest element to make room
+     * - BLOCK: send() spins until there is room; never use it from interrupts or from
+     *   the executor that runs the consumer
+     *
+     * @tparam T Element type, copied in and out, default constructible
+     * @tparam N Capacity, must be a power of two
+     *
+     * @note Only the consumer may call receive() and drain()
+     */
+    template<typename T, size_t N>
+    class Channel : public ChannelPolicy {
+        private:
+            MpscQueue<T, N> queue;
+            Task * consumer = nullptr;
+            std::atomic<bool> signalled;    ///< The consumer was demanded and has not read since
+            std::atomic<uint32_t> dropped;  ///< Elements lost to the overflow policy
+            CriticalSection reading;        ///< Held while an element is popped
+            int policy;
+
+            /**
+             * @brief Demand the consumer unless it is demanded already
+             */
+            void signal() {
+                if(this->consumer != nullptr && !this->signalled.exchange(true, std::memory_order_acq_rel)) {
+                    this->consumer->demand();
+                }
+            }
+
+            /**
+             * @brief Pop one element, consumers and DROP_OLDEST producers take turns
+             */
+            bool pop(T & item) {
+                this->reading.lock();
+                bool popped = this->queue.pop(item);
+                this->reading.unlock();
+                return popped;
+            }
+
+            /**
+             * @brief Check for elements without racing a DROP_OLDEST producer
+             */
+            bool waiting() {
+                this->reading.lock();
+                bool available = !this->queue.empty();
+                this->reading.unlock();
+                return available;
+            }
+
+            /**
+             * @brief Let the next send() demand the consumer again
+             *
+             * @details An exchange rather than a store: it is ordered with the exchange
+             * in signal(), so a producer that still saw the old flag has its element
+             * visible to the following pop().
+             */
+            void rearm() {
+                this->signalled.exchange(false, std::memory_order_acq_rel);
+            }
+
+        public:
+            /**
+             * @brief Create a channel
+             * @param policy DROP_NEWEST (default), DROP_OLDEST or BLOCK
+             */
+            explicit Channel(int policy = DROP_NEWEST) : signalled(false), dropped(0), policy(policy) {}
+
+            /**
+             * @brief Set the Task to demand when data arrives
+             * @param task DEMAND task that reads the channel, e.g. from Executor::onDemand()
+             */
+            void setConsumer(Task * task) {
+                this->consumer = task;
+
+                if(waiting()) {
+                    rearm();
+                    signal();
+                }
+            }
+
+            /**
+             * @brief Append an element (any producer, interrupts included)
+             * @param item Element to copy into the channel
+             * @return true if stored, false if dropped by the overflow policy
+             */
+            bool send(const T & item) {
+                while(!this->queue.push(item)) {
+                    if(this->policy == BLOCK) {
+                        signal();
+                        continue;
+                    }
+
+                    if(this->policy == DROP_OLDEST) {
+                        T oldest;
+
+                        if(pop(oldest)) {
+                            this->dropped.fetch_add(1, std::memory_order_relaxed);
+                        }
+
+                        continue;
+                    }
+
+                    this->dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+
+                signal();
+                return true;
+            }
+
+            /**
+             * @brief Remove the oldest element (consumer side)
+             * @param[out] item Receives the element
+             * @return true if an element was removed, false if the channel is empty
+             */
+            bool receive(T & item) {
+                if(pop(item)) {
+                    return true;
+                }
+
+                // Elements sent from now on demand the consumer again
+                rearm();
+                return pop(item);
+            }
+
+            /**
+             * @brief Hand every waiting element to a callable (consumer side)
+             * @param func Callable taking a const T&
+             * @param max Most elements to take; the consumer is demanded again if more remain
+             * @return size_t Number of elements handed over
+             */
+            template<typename Func>
+            size_t drain(Func func, size_t max = N) {
+                // Elements sent from now on demand the consumer again
+                rearm();
+
+                size_t count = 0;
+                T item;
+
+                while(count < max && pop(item)) {
+                    func(item);
+                    count++;
+                }
+
+                if(count == max && waiting()) {
+                    signal();
+                }
+
+                return count;
+            }
+
+            /**
+             * @brief Check whether the channel is empty (consumer side)
+             */
+            bool empty() {
+                return !waiting();
+            }
+
+            /**
+             * @brief Number of elements the channel can hold
+             */
+            size_t capacity() const {
+                return N;
+            }
+
+            /**
+             * @brief Number of elements lost to the overflow policy
+             */
+            uint32_t getDropped() const {
+                return this->dropped.load(std::memory_order_relaxed);
+            }
+    };
+}
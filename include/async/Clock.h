@@ -0,0 +1,94 @@
+#pragma once
+#include <Arduino.h>
+#include <async/Config.h>
+
+/**
+ * @file Clock.h
+ * @brief Defines async::Clock, the monotonic time source behind all library timing.
+ */
+
+///@name Clock Backends
+///@{
+#define ASYNC_CLOCK_ARDUINO 0    ///< micros() extended to 64 bits in software
+#define ASYNC_CLOCK_ESP_TIMER 1  ///< esp_timer_get_time(), 64-bit in hardware
+#define ASYNC_CLOCK_POSIX 2      ///< clock_gettime(CLOCK_MONOTONIC)
+#define ASYNC_CLOCK_VIRTUAL 3    ///< Only moves through Clock::set(), Clock::advance() and delay()
+///@}
+
+/**
+ * @brief Clock backend, one of the ASYNC_CLOCK_* values
+ *
+ * @details Defaults to esp_timer on the ESP32 and to micros() elsewhere, which on the
+ * host shim also follows host::useVirtualClock(). On the host the virtual backend is the
+ * shim's virtual clock, so there is a single virtual time per build.
+ */
+#ifndef ASYNC_CLOCK
+    #if defined(ARDUINO_ARCH_ESP32)
+        #define ASYNC_CLOCK ASYNC_CLOCK_ESP_TIMER
+    #else
+        #define ASYNC_CLOCK ASYNC_CLOCK_ARDUINO
+    #endif
+#endif
+
+#if ASYNC_CLOCK == ASYNC_CLOCK_ESP_TIMER
+    #include <esp_timer.h>
+#endif
+
+namespace async {
+    /**
+     * @class Clock
+     * @brief Monotonic 64-bit time since boot
+     *
+     * @details Every scheduler, Task, Chain and Duration::now() read time from here, so
+     * timestamps never wrap in practice (584,000 years of microseconds) and differences
+     * between them stay correct over long uptimes. The executor reads the clock once per
+     * pass and hands that value to every timed object it checks.
+     *
+     * With the Arduino backend the 32-bit micros() counter, which wraps every ~71.6
+     * minutes, is extended in software. The wrap is detected on a later read, so the
+     * clock must be read at least once every ~35 minutes; a running executor does that
+     * on every pass.
+     *
+     * @note Interrupt handlers keep using the 32-bit micros() for their timestamps
+     */
+    class Clock {
+        public:
+            /**
+             * @brief Get the time since boot in microseconds
+             * @return uint64_t Monotonic microsecond counter
+             */
+#if ASYNC_CLOCK == ASYNC_CLOCK_ESP_TIMER
+            static uint64_t micros() {
+                return (uint64_t) esp_timer_get_time();
+            }
+#else
+            static uint64_t micros();
+#endif
+
+            /**
+             * @brief Get the time since boot in milliseconds
+             * @return uint64_t Monotonic millisecond counter
+             */
+            static uint64_t millis() {
+                return micros() / 1000;
+            }
+
+            /**
+             * @brief Set the virtual clock
+             * @param us Microseconds since boot
+             *
+             * @note Available with ASYNC_CLOCK_VIRTUAL, and on the host shim with the
+             * micros() backend, where it moves the shim clock and must not go backwards
+             */
+            static void set(uint64_t us);
+
+            /**
+             * @brief Move the virtual clock forward
+             * @param us Microseconds to add
+             *
+             * @note Available with ASYNC_CLOCK_VIRTUAL, and on the host shim with the
+             * micros() backend
+             */
+            static void advance(uint64_t us);
+    };
+}
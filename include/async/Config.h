@@ -0,0 +1,156 @@
+#pragma once
+
+/**
+ * @file Config.h
+ * @brief Compile-time configuration of the async library
+ *
+ * @details Every option can be overridden from the build, e.g. in platformio.ini:
+ * @code
+ * build_flags = -D ASYNC_TASK_POOL_SIZE=64
+ * @endcode
+ */
+
+/**
+ * @brief Capacity of the static Task pool, 0 allocates Tasks on the heap
+ */
+#ifndef ASYNC_TASK_POOL_SIZE
+#define ASYNC_TASK_POOL_SIZE 0
+#endif
+
+/**
+ * @brief Capacity of the static Chain step pool (per Chain value type), 0 allocates steps on the heap
+ */
+#ifndef ASYNC_OPERATION_POOL_SIZE
+#define ASYNC_OPERATION_POOL_SIZE 0
+#endif
+
+/**
+ * @brief Inline storage of callbacks in bytes, larger captures fail to compile
+ *
+ * @details A fixed byte count, so a capture that compiles on the host also fits on a
+ * 32-bit target: 32 bytes hold eight pointers on ESP32 and four on a 64-bit host.
+ */
+#ifndef ASYNC_CALLBACK_SIZE
+#define ASYNC_CALLBACK_SIZE 32
+#endif
+
+/**
+ * @brief Set to 1 to move callbacks that exceed ASYNC_CALLBACK_SIZE to the heap
+ */
+#ifndef ASYNC_CALLBACK_HEAP
+#define ASYNC_CALLBACK_HEAP 0
+#endif
+
+/**
+ * @brief Number of interrupt edges a Pin can buffer between two ticks, must be a power of two
+ */
+#ifndef ASYNC_PIN_QUEUE_SIZE
+#define ASYNC_PIN_QUEUE_SIZE 32
+#endif
+
+/**
+ * @brief Number of pins that can end light sleep, see Sleep::addWakePin() (ESP32)
+ */
+#ifndef ASYNC_SLEEP_WAKE_PINS
+#define ASYNC_SLEEP_WAKE_PINS 8
+#endif
+
+/**
+ * @brief Stack size in bytes of MultiExecutor worker tasks (ESP32)
+ */
+#ifndef ASYNC_WORKER_STACK_SIZE
+#define ASYNC_WORKER_STACK_SIZE 4096
+#endif
+
+/**
+ * @brief FreeRTOS priority of MultiExecutor worker tasks (ESP32)
+ */
+#ifndef ASYNC_WORKER_PRIORITY
+#define ASYNC_WORKER_PRIORITY 1
+#endif
+
+/**
+ * @brief Set to 1 to collect per-Tick and Executor statistics, 0 compiles them out
+ */
+#ifndef ASYNC_STATS
+#define ASYNC_STATS 0
+#endif
+
+/**
+ * @brief Set to 1 to record executor activity into the trace ring buffer, 0 compiles it out
+ */
+#ifndef ASYNC_TRACE
+#define ASYNC_TRACE 0
+#endif
+
+/**
+ * @brief Number of events kept by the trace ring buffer, must be a power of two
+ */
+#ifndef ASYNC_TRACE_SIZE
+#define ASYNC_TRACE_SIZE 1024
+#endif
+
+/**
+ * @brief Set to 1 to queue log calls and format them later in Log::drain()
+ */
+#ifndef ASYNC_LOG_DEFERRED
+#define ASYNC_LOG_DEFERRED 0
+#endif
+
+/**
+ * @brief Number of log records the deferred queue holds, must be a power of two
+ */
+#ifndef ASYNC_LOG_QUEUE_SIZE
+#define ASYNC_LOG_QUEUE_SIZE 32
+#endif
+
+/**
+ * @brief Maximum number of arguments captured per deferred log call
+ */
+#ifndef ASYNC_LOG_MAX_ARGS
+#define ASYNC_LOG_MAX_ARGS 8
+#endif
+
+/**
+ * @brief Bytes per deferred log record for copies of string arguments
+ */
+#ifndef ASYNC_LOG_TEXT_SIZE
+#define ASYNC_LOG_TEXT_SIZE 48
+#endif
+
+/**
+ * @brief Lowest log level compiled in (0=trace ... 4=error, 5=none)
+ *
+ * @details Macros below this level expand to nothing, their arguments are not evaluated.
+ */
+#ifndef ASYNC_LOG_LEVEL
+#define ASYNC_LOG_LEVEL 0
+#endif
+
+/**
+ * @brief Set to 1 to replace format strings by 32-bit IDs, see tools/log_decode.py
+ */
+#ifndef ASYNC_LOG_INTERN
+#define ASYNC_LOG_INTERN 0
+#endif
+
+/**
+ * @brief Number of source files that can have their own runtime log level
+ */
+#ifndef ASYNC_LOG_FILE_LEVELS
+#define ASYNC_LOG_FILE_LEVELS 8
+#endif
+
+/**
+ * @brief Bytes per pooled coroutine frame, larger frames are allocated on the heap
+ */
+#ifndef ASYNC_COROUTINE_FRAME_SIZE
+#define ASYNC_COROUTINE_FRAME_SIZE 256
+#endif
+
+/**
+ * @brief Number of pooled coroutine frames
+ */
+#ifndef ASYNC_COROUTINE_POOL_SIZE
+#define ASYNC_COROUTINE_POOL_SIZE 8
+#endif
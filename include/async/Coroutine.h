@@ -0,0 +1,499 @@
+#pragma once
+#include <Arduino.h>
+#include <async/Tick.h>
+#include <async/Duration.h>
+#include <async/Pin.h>
+#include <async/Semaphore.h>
+#include <async/Pool.h>
+#include <async/Config.h>
+
+/**
+ * @file Coroutine.h
+ * @brief Defines async::co_task, C++20 coroutines that run on an Executor.
+ *
+ * @details Only available when the compiler implements coroutines (__cpp_impl_coroutine),
+ * e.g. GCC 11+ with -std=c++20.
+ */
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace async {
+    class CoroutineTick;
+
+    /**
+     * @brief Condition a suspended coroutine waits for, polled by its CoroutineTick
+     */
+    class CoroutineWaiter {
+        public:
+            /**
+             * @brief Check whether the coroutine can be resumed
+             * @param now Current uptimeMicros() time
+             */
+            virtual bool ready(uint64_t now) = 0;
+
+            /**
+             * @brief Earliest time at which ready() may become true, see Tick::wakeTime()
+             */
+            virtual uint64_t wakeTime() = 0;
+
+            /**
+             * @brief Time until which the coroutine needs no tick, see Tick::deadline()
+             * @return uint64_t 0 (default) to be polled every pass; a waiter that wakes
+             * its root Tick when ready() becomes true returns its timeout or NEVER
+             */
+            virtual uint64_t deadline() {
+                return 0;
+            }
+
+        protected:
+            ~CoroutineWaiter() = default;
+    };
+
+    /**
+     * @brief Storage unit of the coroutine frame pool
+     */
+    struct CoroutineFrame {
+        alignas(alignof(std::max_align_t)) unsigned char bytes[ASYNC_COROUTINE_FRAME_SIZE];
+    };
+
+    /**
+     * @brief Pool all coroutine frames are allocated from
+     * @return Pool of ASYNC_COROUTINE_POOL_SIZE frames; larger frames go to the heap
+     */
+    inline Pool<CoroutineFrame, ASYNC_COROUTINE_POOL_SIZE> & coroutineFrames() {
+        static Pool<CoroutineFrame, ASYNC_COROUTINE_POOL_SIZE> pool;
+        return pool;
+    }
+
+    /**
+     * @brief Promise state shared by every co_task
+     */
+    class CoroutinePromise {
+        public:
+            CoroutineTick * root = nullptr;         ///< Tick that resumes the coroutine tree
+            std::coroutine_handle<> continuation;   ///< Coroutine awaiting this one
+
+            static void * operator new(size_t size) {
+                return coroutineFrames().allocate(size);
+            }
+
+            static void operator delete(void * ptr) {
+                coroutineFrames().deallocate(ptr);
+            }
+
+            /**
+             * @brief Hands control back to the awaiting coroutine when finished
+             */
+            struct FinalAwaiter {
+                bool await_ready() noexcept { return false; }
+
+                template<typename P>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) noexcept {
+                    std::coroutine_handle<> next = handle.promise().continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+
+                void await_resume() noexcept {}
+            };
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            FinalAwaiter final_suspend() noexcept { return {}; }
+            void unhandled_exception() { std::terminate(); }
+    };
+
+    /**
+     * @brief Result storage of a co_task promise
+     * @tparam T Result type
+     */
+    template<typename T>
+    class CoroutineResult : public CoroutinePromise {
+        private:
+            std::optional<T> value;
+
+        public:
+            void return_value(T result) {
+                value = std::move(result);
+            }
+
+            T result() {
+                return std::move(*value);
+            }
+    };
+
+    template<>
+    class CoroutineResult<void> : public CoroutinePromise {
+        public:
+            void return_void() {}
+            void result() {}
+    };
+
+    /**
+     * @class co_task
+     * @brief Coroutine that runs on an Executor
+     *
+     * @details A co_task starts suspended. The outermost one is handed to an executor
+     * with spawn(); nested ones start when they are awaited and resume their caller when
+     * they finish, without going through the executor. Frames come from a fixed pool
+     * (ASYNC_COROUTINE_POOL_SIZE frames of ASYNC_COROUTINE_FRAME_SIZE bytes), so steps
+     * do not allocate.
+     *
+     * Inside a co_task:
+     * - co_await co::delay(ms) resumes after a delay
+     * - co_await pin->edge(RISING, timeout) resumes on an edge (true) or timeout (false)
+     * - co_await semaphore resumes once the semaphore is acquired
+     * - co_await other() runs another co_task and yields its result
+     *
+     * @note GCC 12 miscompiles a co_await directly inside an if() condition, the
+     * coroutine body never runs; store the result in a variable first.
+     *
+     * @tparam T Result type, void by default
+     */
+    template<typename T = void>
+    class co_task {
+        public:
+            class promise_type : public CoroutineResult<T> {
+                public:
+                    co_task get_return_object() {
+                        return co_task(std::coroutine_handle<promise_type>::from_promise(*this));
+                    }
+            };
+
+        private:
+            std::coroutine_handle<promise_type> handle;
+
+            explicit co_task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+            friend class CoroutineTick;
+
+        public:
+            co_task(co_task && other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+            co_task(const co_task &) = delete;
+            co_task & operator=(const co_task &) = delete;
+
+            ~co_task() {
+                if(handle) {
+                    handle.destroy();
+                }
+            }
+
+            /**
+             * @brief Check whether the coroutine has returned
+             */
+            bool done() const {
+                return !handle || handle.done();
+            }
+
+            /**
+             * @brief Awaiter that starts the task and yields its result
+             */
+            struct Awaiter {
+                std::coroutine_handle<promise_type> handle;
+
+                bool await_ready() {
+                    return !handle || handle.done();
+                }
+
+                template<typename P>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<P> caller) {
+                    handle.promise().root = caller.promise().root;
+                    handle.promise().continuation = caller;
+                    return handle;
+                }
+
+                T await_resume() {
+                    return handle.promise().result();
+                }
+            };
+
+            Awaiter operator co_await() && {
+                return Awaiter { handle };
+            }
+    };
+
+    /**
+     * @class CoroutineTick
+     * @brief Tick that runs a co_task<void> on an executor
+     *
+     * @details On each tick the coroutine tree is resumed if the condition it is waiting
+     * for is met; wakeTime() reports that condition's time, so the executor can sleep
+     * through delays, and deadline() lets it keep a waiting coroutine out of its polling
+     * list until a timeout or a wake() from the awaited pin or semaphore. The Tick finishes, and is deleted by the executor, when the
+     * coroutine returns.
+     */
+    class CoroutineTick : public Tick {
+        private:
+            co_task<void> task;
+            CoroutineWaiter * waiter = nullptr;     ///< Condition of the suspended coroutine
+            std::coroutine_handle<> waiting;        ///< Innermost suspended coroutine
+            bool started = false;
+            bool cancelled = false;
+
+        public:
+            explicit CoroutineTick(co_task<void> && task) : task(std::move(task)) {
+                if(this->task.handle) {
+                    this->task.handle.promise().root = this;
+                }
+            }
+
+            /**
+             * @brief Register the condition a coroutine of this tree is suspended on
+             * @param waiter Condition, lives in the suspended coroutine frame
+             * @param handle Coroutine to resume
+             */
+            void wait(CoroutineWaiter * waiter, std::coroutine_handle<> handle) {
+                this->waiter = waiter;
+                this->waiting = handle;
+            }
+
+            bool tick() override {
+                if(this->cancelled || this->task.done()) {
+                    return false;
+                }
+
+                if(!this->started) {
+                    this->started = true;
+                    this->task.handle.resume();
+                }
+                else if(this->waiter != nullptr && this->waiter->ready(uptimeMicros())) {
+                    std::coroutine_handle<> handle = this->waiting;
+                    this->waiter = nullptr;
+                    handle.resume();
+                }
+
+                return !this->task.done();
+            }
+
+            uint64_t wakeTime() override {
+                if(!this->started || this->waiter == nullptr) {
+                    return 0;
+                }
+
+                return this->waiter->wakeTime();
+            }
+
+            /**
+             * @brief Get the time at which the suspended coroutine needs its next tick
+             * @return uint64_t deadline() of the awaited condition, 0 before the first
+             * resume or once finished or cancelled
+             */
+            uint64_t deadline() override {
+                if(this->cancelled || this->task.done() || !this->started || this->waiter == nullptr) {
+                    return 0;
+                }
+
+                return this->waiter->deadline();
+            }
+
+            bool cancel() override {
+                this->cancelled = true;
+                return true;
+            }
+    };
+
+    /**
+     * @brief Wrap a coroutine into a Tick for Executor::add()
+     * @param task Outermost coroutine
+     * @return CoroutineTick* Tick owned by the executor it is added to
+     */
+    inline CoroutineTick * spawn(co_task<void> task) {
+        return new CoroutineTick(std::move(task));
+    }
+
+    /**
+     * @brief Awaitable delay, see co::delay()
+     */
+    class DelayAwaiter : public CoroutineWaiter {
+        private:
+            uint64_t duration;  ///< Delay in microseconds
+            uint64_t until = 0; ///< uptimeMicros() time to resume at
+
+        public:
+            explicit DelayAwaiter(uint64_t us) : duration(us) {}
+
+            bool await_ready() {
+                return this->duration == 0;
+            }
+
+            template<typename P>
+            void await_suspend(std::coroutine_handle<P> handle) {
+                this->until = uptimeMicros() + this->duration;
+                handle.promise().root->wait(this, handle);
+            }
+
+            void await_resume() {}
+
+            bool ready(uint64_t now) override {
+                return now >= this->until;
+            }
+
+            uint64_t wakeTime() override {
+                return this->until;
+            }
+
+            uint64_t deadline() override {
+                return this->until;
+            }
+    };
+
+    /**
+     * @brief Awaitable pin edge, see Pin::edge()
+     *
+     * @details The root Tick waits on the pin while suspended, so an edge wakes it.
+     */
+    class PinEdgeAwaiter : public CoroutineWaiter {
+        private:
+            PinEdge target;
+            uint32_t count = 0;         ///< Edge count when suspended
+            uint64_t until = Tick::NEVER; ///< Timeout time, NEVER for none
+            bool fired = false;
+            CoroutineTick * root = nullptr; ///< Tick added as a waiter of the pin
+
+        public:
+            explicit PinEdgeAwaiter(PinEdge target) : target(target) {}
+
+            PinEdgeAwaiter(const PinEdgeAwaiter &) = delete;
+
+            ~PinEdgeAwaiter() {
+                if(this->root != nullptr) {
+                    this->target.pin->removeWaiter(this->root);
+                }
+            }
+
+            bool await_ready() {
+                return false;
+            }
+
+            template<typename P>
+            void await_suspend(std::coroutine_handle<P> handle) {
+                this->count = this->target.pin->getEdgeCount(this->target.edge);
+
+                if(this->target.timeout != 0xFFFFFFFF) {
+                    this->until = uptimeMicros() + (uint64_t) this->target.timeout * 1000;
+                }
+
+                this->root = handle.promise().root;
+                this->target.pin->addWaiter(this->root);
+                this->root->wait(this, handle);
+            }
+
+            bool await_resume() {
+                return this->fired;
+            }
+
+            bool ready(uint64_t now) override {
+                this->fired = this->target.pin->getEdgeCount(this->target.edge) != this->count;
+
+                if(!this->fired && now < this->until) {
+                    return false;
+                }
+
+                this->target.pin->removeWaiter(this->root);
+                this->root = nullptr;
+                return true;
+            }
+
+            uint64_t wakeTime() override {
+                return this->target.pin->getEdgeCount(this->target.edge) != this->count ? 0 : this->until;
+            }
+
+            uint64_t deadline() override {
+                return wakeTime();
+            }
+    };
+
+    /**
+     * @brief Awaitable semaphore acquisition
+     *
+     * @details The coroutine queues at the semaphore in FIFO order and is resumed once
+     * release() hands it its turn.
+     */
+    class SemaphoreAwaiter : public CoroutineWaiter {
+        private:
+            Semaphore & semaphore;
+            Tick * queued = nullptr;    ///< Tick queued at the semaphore
+
+        public:
+            explicit SemaphoreAwaiter(Semaphore & semaphore) : semaphore(semaphore) {}
+
+            SemaphoreAwaiter(const SemaphoreAwaiter &) = delete;
+
+            ~SemaphoreAwaiter() {
+                if(this->queued != nullptr) {
+                    this->semaphore.forget(this->queued);
+                }
+            }
+
+            bool await_ready() {
+                return this->semaphore.tryAcquire();
+            }
+
+            template<typename P>
+            bool await_suspend(std::coroutine_handle<P> handle) {
+                Tick * root = handle.promise().root;
+
+                if(this->semaphore.tryAcquire(root)) {
+                    return false;
+                }
+
+                this->queued = root;
+                handle.promise().root->wait(this, handle);
+                return true;
+            }
+
+            void await_resume() {}
+
+            bool ready(uint64_t) override {
+                if(!this->semaphore.tryAcquire(this->queued)) {
+                    return false;
+                }
+
+                this->queued = nullptr;
+                return true;
+            }
+
+            uint64_t wakeTime() override {
+                return this->semaphore.ready(this->queued) ? 0 : Tick::NEVER;
+            }
+
+            uint64_t deadline() override {
+                return wakeTime();
+            }
+    };
+
+    inline PinEdgeAwaiter operator co_await(PinEdge edge) {
+        return PinEdgeAwaiter(edge);
+    }
+
+    inline SemaphoreAwaiter operator co_await(Semaphore & semaphore) {
+        return SemaphoreAwaiter(semaphore);
+    }
+
+    /**
+     * @brief Awaitables for co_task
+     *
+     * @details A namespace of their own, so that with "using namespace async" delay()
+     * still means the blocking Arduino function outside of coroutines.
+     */
+    namespace co {
+        /**
+         * @brief Suspend the calling coroutine for a while
+         * @param ms Delay in milliseconds
+         */
+        inline DelayAwaiter delay(unsigned long ms) {
+            return DelayAwaiter((uint64_t) ms * 1000);
+        }
+
+        /**
+         * @brief Suspend the calling coroutine for a while
+         * @param duration Delay with microsecond resolution
+         */
+        inline DelayAwaiter delay(Duration duration) {
+            return DelayAwaiter(duration.get(Duration::MICRO));
+        }
+    }
+}
+#endif
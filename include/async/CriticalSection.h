@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+
+#if defined(ARDUINO_ARCH_ESP32)
+    #include <freertos/FreeRTOS.h>
+#elif defined(ARDUINO)
+    #include <Arduino.h>
+#endif
+
+/**
+ * @file CriticalSection.h
+ * @brief Defines async::CriticalSection, the short lock shared by tasks, cores and interrupts.
+ */
+
+namespace async {
+    /**
+     * @class CriticalSection
+     * @brief Lock for a few instructions of shared state, safe from interrupts
+     *
+     * @details A plain spin lock deadlocks on an RTOS as soon as the holder is preempted
+     * by a higher-priority task or an interrupt on the same core that wants the lock too.
+     * A critical section cannot be preempted on its own core while it is held, so the
+     * other party only ever waits for a holder running on another core.
+     *
+     * Backends:
+     * - ESP32: portMUX spinlock with portENTER_CRITICAL_SAFE(), from tasks and interrupts
+     * - Other Arduino cores (single core): interrupts are disabled while the lock is held;
+     *   unlock() enables them again, so do not lock from interrupts on these cores
+     * - Host builds: std::atomic_flag spin lock, the OS preempts threads fairly
+     *
+     * @note Keep the guarded code short and never block, allocate or log inside it
+     */
+    class CriticalSection {
+        private:
+#if defined(ARDUINO_ARCH_ESP32)
+            portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+#elif !defined(ARDUINO)
+            std::atomic_flag busy = ATOMIC_FLAG_INIT;
+#endif
+
+        public:
+            /**
+             * @brief Enter the critical section, waiting for a holder on another core
+             */
+            void lock() {
+#if defined(ARDUINO_ARCH_ESP32)
+                portENTER_CRITICAL_SAFE(&mux);
+#elif defined(ARDUINO)
+                noInterrupts();
+#else
+                while(busy.test_and_set(std::memory_order_acquire)) {}
+#endif
+            }
+
+            /**
+             * @brief Leave the critical section
+             */
+            void unlock() {
+#if defined(ARDUINO_ARCH_ESP32)
+                portEXIT_CRITICAL_SAFE(&mux);
+#elif defined(ARDUINO)
+                interrupts();
+#else
+                busy.clear(std::memory_order_release);
+#endif
+            }
+    };
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <Arduino.h>
+#include <async/Clock.h>
 
 /**
  * @class Duration
@@ -7,15 +8,25 @@
  * 
  * @details The Duration class provides a comprehensive way to work with time intervals in various units.
  * It supports creation, storage, manipulation, and comparison of durations with microsecond precision
- * (stored internally as milliseconds). The class is particularly useful for timing operations in
+ * (stored internally as microseconds). The class is particularly useful for timing operations in
  * asynchronous tasks and event scheduling.
+ *
+ * Constructors and set() keep taking milliseconds; use us() or setMicros() for sub-millisecond values.
  * 
  * @note All arithmetic operations return new Duration objects rather than modifying existing ones.
  */
 namespace async { 
+    /**
+     * @brief Get the time since boot in microseconds
+     * @return uint64_t Monotonic 64-bit microsecond counter, see Clock
+     */
+    inline uint64_t uptimeMicros() {
+        return Clock::micros();
+    }
+
     class Duration {
         protected:
-            uint64_t valueMillis; ///< Internal storage in milliseconds (64-bit for extended range)
+            uint64_t valueMicros; ///< Internal storage in microseconds (64-bit for extended range)
 
         public:
             /**
@@ -28,7 +39,7 @@ namespace async {
              * @param ms Duration value in milliseconds
              */
             Duration(uint64_t ms) {
-                valueMillis = ms;
+                valueMicros = ms * 1000;
             }
 
             ///@name Time Unit Constants
@@ -45,7 +56,15 @@ namespace async {
              * @param ms New duration value in milliseconds
              */
             void set(uint64_t ms) {
-                this->valueMillis = ms;
+                this->valueMicros = ms * 1000;
+            }
+
+            /**
+             * @brief Set duration value with microsecond resolution
+             * @param us New duration value in microseconds
+             */
+            void setMicros(uint64_t us) {
+                this->valueMicros = us;
             }
 
             /**
@@ -54,7 +73,7 @@ namespace async {
              * @return Duration New Duration object representing the absolute difference
              */
             Duration diff(const Duration& other) const {
-                return Duration(valueMillis - other.valueMillis);
+                return us(valueMicros - other.valueMicros);
             }
         
             /**
@@ -63,7 +82,7 @@ namespace async {
              * @return Duration New Duration object representing the sum
              */
             Duration add(const Duration& other) const {
-                return Duration(valueMillis + other.valueMillis);
+                return us(valueMicros + other.valueMicros);
             }
         
             /**
@@ -72,7 +91,7 @@ namespace async {
              * @return Duration New Duration object representing the difference
              */
             Duration subtract(const Duration& other) const {
-                return Duration(valueMillis - other.valueMillis);
+                return us(valueMicros - other.valueMicros);
             }
 
             /**
@@ -81,7 +100,7 @@ namespace async {
              * @return bool True if this Duration is after the other, false otherwise
              */
             bool after(const Duration& other) const {
-                return valueMillis > other.valueMillis;
+                return valueMicros > other.valueMicros;
             }
 
             /**
@@ -90,7 +109,7 @@ namespace async {
              * @return bool True if this Duration is before the other, false otherwise
              */
             bool before(const Duration& other) const {
-                return valueMillis < other.valueMillis;
+                return valueMicros < other.valueMicros;
             }
 
             /**
@@ -99,18 +118,17 @@ namespace async {
              * @return uint64_t Duration value converted to the requested unit
              * 
              * @note Conversion details:
-             * - MICRO: Returns milliseconds * 1000 (no fractional microseconds)
-             * - SECONDS/MINUTES/HOURS: Uses integer division (truncates remainder)
+             * - MILLIS/SECONDS/MINUTES/HOURS: Uses integer division (truncates remainder)
              * - Default unit is milliseconds (MILLIS)
              */
             uint64_t get(int type = MILLIS) {
                 switch(type) {
-                    case MICRO:   return valueMillis * 1000L;
-                    case MILLIS:  return valueMillis;
-                    case SECONDS: return valueMillis / 1000L;
-                    case MINUTES: return valueMillis / (1000L * 60);
-                    case HOURS:   return valueMillis / (1000L * 3600);
-                    default:      return valueMillis;
+                    case MICRO:   return valueMicros;
+                    case MILLIS:  return valueMicros / 1000ULL;
+                    case SECONDS: return valueMicros / 1000000ULL;
+                    case MINUTES: return valueMicros / (1000000ULL * 60);
+                    case HOURS:   return valueMicros / (1000000ULL * 3600);
+                    default:      return valueMicros / 1000ULL;
                 }
             };
 
@@ -119,16 +137,14 @@ namespace async {
 
             /**
              * @brief Get current time as a Duration object
-             * @return Duration* New Duration object representing current time
-             * 
-             * @note The caller is responsible for managing the returned pointer
+             * @return Duration Time since boot with microsecond resolution
              */
             static Duration now() {
-                return Duration(millis());
+                return us(uptimeMicros());
             };
 
             static Duration maximum() {
-                return Duration((uint64_t)-1);
+                return us((uint64_t)-1);
             };
 
             /**
@@ -148,15 +164,25 @@ namespace async {
                 return Duration(ms);
             };
 
+            /**
+             * @brief Create a Duration from microseconds
+             * @param us Time value in microseconds
+             * @return Duration New Duration object
+             */
+            static Duration us(uint64_t us) {
+                Duration duration(0);
+                duration.valueMicros = us;
+                return duration;
+            };
+
             /**
              * @brief Convert the duration to a human-readable string
              * @return String Representation of the duration in milliseconds
              * 
              * @note The string format is a simple decimal number (e.g., "1234")
-             * @note Negative values are prefixed with '-' (though unlikely with time durations)
              */
             String toString() {
-                uint64_t num = valueMillis;
+                uint64_t num = valueMicros / 1000ULL;
 
                 static char buf[22];
                 char* p = &buf[sizeof(buf)-1];
@@ -165,9 +191,6 @@ namespace async {
                     *--p = '0' + (num%10);
                     num /= 10;
                 } while ( num > 0 );
-                if( (byte)((num & bit(64))>>63) == 1 ){
-                    *--p = '-';
-                }
                 return p;
             }
     };
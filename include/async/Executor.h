@@ -2,7 +2,16 @@
 #include <async/Task.h>
 #include <async/Tick.h>
 #include <async/Callbacks.h>
-#include <vector>
+#include <async/TimerQueue.h>
+#include <async/TickList.h>
+#include <async/WakeQueue.h>
+#include <async/Sleep.h>
+#include <async/Config.h>
+#include <async/Trace.h>
+
+#if ASYNC_STATS
+    #include <async/Stats.h>
+#endif
 
 namespace async { 
     /**
@@ -14,33 +23,325 @@ namespace async {
      * specific timing requirements. The class provides various methods to schedule different
      * types of tasks with different timing behaviors.
      * 
+     * In TIMERS mode every Tick that reports a deadline() is kept in a min-heap
+     * keyed on its due time instead of the polling list. Each tick() then reads the
+     * clock once and only touches the timers that are due, so the per-tick cost
+     * scales with the number of due tasks rather than with the total number of tasks.
+     *
+     * Objects whose deadline() is NEVER, such as a Chain waiting for a semaphore, are
+     * parked in a list that is never iterated; Tick::wake() queues them and the next
+     * pass moves them back. With TIMERS, a pass therefore only touches runnable objects.
+     *
+     * Within a pass, objects run by Tick::getPriority(), highest level first, and in
+     * insertion order within a level. Expired timers of a level run before its polled
+     * objects, earliest deadline first. With setDeadlineFirst() expired timers of all
+     * levels run ahead of polled work, ordered by deadline alone. A time budget set with
+     * setBudget() ends the pass early; the objects that did not get their turn run first
+     * in the next pass of their level.
+     * 
      * @note Inherits from Tick, allowing executors to be nested within other executors.
      */
     class Executor : public Tick {
         private:
-            std::vector<Tick*> list; ///< List of managed Tick objects
+            TickList list[PRIORITY_LEVELS];  ///< Ticks polled on every pass, per priority
+            TickList added[PRIORITY_LEVELS]; ///< Ticks added during the current pass, per priority
+            TickList due[PRIORITY_LEVELS];   ///< Expired timers waiting for their turn, per priority
+            TickList parked;                 ///< Ticks waiting for wake()
+            TimerQueue timers;       ///< Ticks waiting for their deadline (TIMERS mode)
+            Sleep sleeper;           ///< Idles sleep(), ended by wake() of a managed Tick
+            WakeQueue wakes;         ///< Ticks woken since the last pass
+            Tick * cursor = nullptr; ///< Next Tick of the running iteration
+            Tick * current = nullptr;///< Tick being dispatched
+            bool currentRemoved = false; ///< remove() was called for the current Tick
+            bool ticking = false;    ///< Set while tick() iterates
+            int mode;                ///< Scheduling mode (POLL or TIMERS)
             bool begin = false;
+            volatile bool running = false; ///< Set while run() is looping
+            bool deadlineFirst = false; ///< Expired timers of every level run first, by deadline
+            uint32_t budget = 0;        ///< Time budget of one pass in microseconds, 0 for none
+            uint64_t passStart = 0;     ///< uptimeMicros() at the start of the pass (budget only)
+            bool progressed = false;    ///< Something was dispatched in the current pass
+            uint32_t deferrals = 0;     ///< Passes ended early by the budget
+#if ASYNC_STATS
+            ExecutorStats stats;        ///< Loop counters
+#endif
+
+            /**
+             * @brief Cancel and delete a Tick that left the executor
+             * @param tick Pointer to the Tick object, only cancelled if not owned
+             */
+            void destroy(Tick * tick) {
+                wakes.detach(tick);
+                tick->cancel();
+
+                if(tick->isOwned()) {
+                    delete tick;
+                }
+            }
+
+            /**
+             * @brief Detach a Tick from the timer queue or whichever list holds it
+             * @param tick Pointer to the Tick object
+             *
+             * @note Advances the iteration cursor if it points at the detached Tick
+             */
+            void unlink(Tick * tick) {
+                if(timers.remove(tick)) {
+                    return;
+                }
+
+                TickList * owner = TickList::of(tick);
+
+                if(owner != nullptr) {
+                    if(tick == cursor) {
+                        cursor = TickList::next(tick);
+                    }
+
+                    owner->remove(tick);
+                }
+            }
+
+            /**
+             * @brief Append a Tick to the polling list
+             * @param tick Pointer to the Tick object
+             *
+             * @note Ticks added while tick() iterates are polled from the next pass on
+             */
+            void enlist(Tick * tick) {
+                if(this->ticking) {
+                    added[tick->getPriority()].pushBack(tick);
+                }
+                else {
+                    list[tick->getPriority()].pushBack(tick);
+                }
+            }
+
+            /**
+             * @brief Check whether a list holds expired timers
+             * @param owner List to check
+             */
+            bool isDue(TickList * owner) {
+                return owner >= &due[0] && owner < &due[PRIORITY_LEVELS];
+            }
+
+            /**
+             * @brief Check whether the time budget of the pass is spent
+             */
+            bool exhausted() {
+                return this->budget > 0 && uptimeMicros() - this->passStart >= this->budget;
+            }
+
+            /**
+             * @brief Put a Tick into the parked list, the timer queue or the polling list
+             * @param tick Pointer to the Tick object, not stored anywhere
+             * @param now Current time in microseconds (TIMERS mode only)
+             */
+            void schedule(Tick * tick, uint64_t now) {
+                uint64_t deadline = tick->deadline();
+
+                if(deadline == NEVER) {
+                    parked.pushBack(tick);
+                }
+                else if(this->mode == TIMERS && deadline > now) {
+                    timers.push(tick, deadline);
+                }
+                else {
+                    enlist(tick);
+                }
+            }
+
+            /**
+             * @brief Tick one object, then keep, requeue or destroy it
+             * @param tick Pointer to the Tick object
+             * @param now Current time in microseconds (TIMERS mode only)
+             * @param expired True if the Tick left the timer queue in this pass
+             */
+            void dispatch(Tick * tick, uint64_t now, bool expired) {
+#if ASYNC_STATS
+                uint64_t scheduled = tick->deadline();
+                uint64_t started = uptimeMicros();
+#endif
+#if ASYNC_TRACE
+                // Idle polling would flush the buffer, only record objects that have work
+                uint64_t wake = expired ? 0 : tick->wakeTime();
+                bool traced = wake == 0 || wake <= uptimeMicros();
+#endif
+                this->current = tick;
+#if ASYNC_TRACE
+                if(traced) {
+                    ASYNC_TRACE_EVENT(Trace::BEGIN, Trace::DISPATCH, tick, 0);
+                }
+#endif
+                bool keep = expired ? tick->expire(now) : tick->tick();
+#if ASYNC_TRACE
+                if(traced) {
+                    ASYNC_TRACE_EVENT(Trace::END, Trace::DISPATCH, tick, 0);
+                }
+#endif
+                this->current = nullptr;
+#if ASYNC_STATS
+                record(tick, scheduled, started, keep);
+#endif
+
+                if(this->currentRemoved) {
+                    this->currentRemoved = false;
+                    destroy(tick);
+                    return;
+                }
+
+                if(!keep) {
+                    unlink(tick);
+                    destroy(tick);
+                    return;
+                }
+
+                uint64_t deadline = tick->deadline();
+
+                if(deadline == NEVER) {
+                    unlink(tick);
+                    parked.pushBack(tick);
+                }
+                else if(this->mode == TIMERS && deadline > now) {
+                    unlink(tick);
+                    timers.push(tick, deadline);
+                }
+                else if(TickList::of(tick) != &list[tick->getPriority()]) {
+                    unlink(tick);
+                    enlist(tick);
+                }
+            }
+
+#if ASYNC_STATS
+            /**
+             * @brief Update the counters of a dispatched Tick
+             * @param tick Pointer to the Tick object, still alive
+             * @param scheduled deadline() before the dispatch
+             * @param started uptimeMicros() before the dispatch
+             * @param keep Result of the dispatch
+             *
+             * @details A timed object counts as fired when its deadline had passed and
+             * the dispatch moved it to a new deadline or ended it.
+             */
+            void record(Tick * tick, uint64_t scheduled, uint64_t started, bool keep) {
+                uint32_t elapsed = uptimeMicros() - started;
+                TickStats & counters = tick->getStats();
+
+                counters.runs++;
+                counters.totalMicros += elapsed;
+
+                if(elapsed > counters.maxMicros) {
+                    counters.maxMicros = elapsed;
+                }
+
+                if(scheduled > 0 && scheduled <= started && (!keep || tick->deadline() != scheduled)) {
+                    uint32_t late = started - scheduled;
+                    counters.fired++;
+                    counters.totalLateMicros += late;
+
+                    if(late > counters.maxLateMicros) {
+                        counters.maxLateMicros = late;
+                    }
+                }
+            }
+#endif
+
+            /**
+             * @brief Dispatch every Tick of a list
+             * @param from List to iterate, may be modified by the dispatched Ticks
+             * @param now Current time in microseconds (TIMERS mode only)
+             * @param expired True for the lists of expired timers
+             * @return bool False if the time budget ran out before the end of the list
+             */
+            bool pass(TickList & from, uint64_t now, bool expired) {
+                Tick * tick = from.first();
+
+                while(tick != nullptr) {
+                    if(this->progressed && exhausted()) {
+                        // Polled objects that missed their turn go first next time,
+                        // expired timers simply stay in their due list
+                        from.rotate(tick);
+                        this->deferrals++;
+                        return false;
+                    }
+
+                    this->cursor = TickList::next(tick);
+                    dispatch(tick, now, expired);
+                    this->progressed = true;
+                    tick = this->cursor;
+                }
+
+                this->cursor = nullptr;
+                return true;
+            }
 
         public:
-            Executor() {}
+            ///@name Executor Mode Constants
+            ///@{
+            static int const POLL = 0;   ///< Tick every managed object on every pass
+            static int const TIMERS = 1; ///< Keep timed objects in a deadline-ordered queue
+            ///@}
+
+            /**
+             * @brief Construct an executor
+             * @param mode Scheduling mode, POLL (default) or TIMERS
+             */
+            Executor(int mode = POLL) : wakes(this, &sleeper), mode(mode) {}
+
+            /**
+             * @brief Cancel and delete the managed Tick objects
+             *
+             * @note Objects that are not owned (see Tick::setOwned()) are only cancelled
+             */
+            ~Executor() {
+                for(int level = PRIORITY_LOW; level <= PRIORITY_HIGH; level++) {
+                    TickList * lists[] = { &list[level], &added[level], &due[level] };
+
+                    for(TickList * from : lists) {
+                        while(Tick * tick = from->first()) {
+                            from->remove(tick);
+                            destroy(tick);
+                        }
+                    }
+                }
 
+                while(Tick * tick = timers.pop()) {
+                    destroy(tick);
+                }
+
+                while(Tick * tick = parked.first()) {
+                    parked.remove(tick);
+                    destroy(tick);
+                }
+            }
+
+            /**
+             * @brief Start the executor, objects added from now on are started on add()
+             *
+             * @note Call it before adding work: Tasks added before start() are not started
+             * and stay parked, so they never run
+             */
             bool start() override {
                 this->begin = true;
+#if ASYNC_STATS
+                this->stats.since = uptimeMicros();
+#endif
                 return true;
             }
             /**
              * @brief Add a Tick object to the executor's management
              * @param tick Pointer to the Tick object to be added
              * 
-             * @note The executor will call start() on the Tick object upon addition
+             * @note The executor will call start() on the Tick object upon addition, once
+             * the executor itself was started; a Task added before start() stays parked
              * @note The executor takes ownership of the Tick object's lifecycle
              */
             void add(Tick * tick) {
-                list.push_back(tick);
-
                 if(this->begin) {
                     tick->start();
                 }
+
+                wakes.attach(tick);
+                schedule(tick, this->mode == TIMERS ? uptimeMicros() : 0);
             }
 
             // TODO
@@ -52,11 +353,19 @@ namespace async {
              * @param tick Pointer to the Tick object to be removed
              * 
              * @note The executor will call cancel() on the Tick object upon removal
+             * @note O(1) for polled objects, O(log n) for queued timers. Safe to call
+             * from inside tick(), including for the object currently being ticked,
+             * which is deleted once its tick() has returned.
              */
             void remove(Tick * tick) {
-                list.erase(std::remove(this->list.begin(), this->list.end(), tick));
-                tick->cancel();
-                delete tick;
+                unlink(tick);
+
+                if(tick == this->current) {
+                    this->currentRemoved = true;
+                    return;
+                }
+
+                destroy(tick);
             }
 
             /**
@@ -65,19 +374,257 @@ namespace async {
              * 
              * @details Iterates through all managed Tick objects and calls their tick() method.
              * If a Tick's tick() returns false, it is automatically removed from the executor.
+             * In TIMERS mode the due timers are expired first, against a single clock read.
+             * Objects may be added or removed by the ticked callbacks; additions take part
+             * from the next pass on.
              */
             bool tick() {
-                for(int i=0, size=list.size(); i < size; i++) {
-                    Tick * tick = list.at(i);
+#if ASYNC_STATS
+                uint64_t began = uptimeMicros();
+#endif
+                uint64_t now = this->mode == TIMERS ? uptimeMicros() : 0;
+                this->passStart = this->budget > 0 ? (now > 0 ? now : uptimeMicros()) : 0;
+                this->progressed = false;
+
+                wakes.drain([this](Tick * tick) {
+                    if(TickList::of(tick) == &parked || timers.contains(tick)) {
+                        unlink(tick);
+                        enlist(tick);
+                    }
+                });
+
+                this->ticking = true;
+
+                if(this->mode == TIMERS) {
+                    while(!timers.empty() && timers.nextDue() <= now) {
+                        Tick * tick = timers.pop();
+                        due[this->deadlineFirst ? PRIORITY_HIGH : tick->getPriority()].pushBack(tick);
+                    }
+                }
+
+                bool open = true;
 
-                    if(!tick->tick()) {
-                        remove(tick);
+                for(int level = PRIORITY_HIGH; level >= PRIORITY_LOW && open; level--) {
+                    if(this->mode == TIMERS) {
+                        open = pass(due[level], now, true);
+                    }
+
+                    if(open) {
+                        open = pass(list[level], now, false);
                     }
                 }
 
+                this->ticking = false;
+
+                for(int level = PRIORITY_LOW; level <= PRIORITY_HIGH; level++) {
+                    list[level].splice(added[level]);
+                }
+
+#if ASYNC_STATS
+                this->stats.record(uptimeMicros() - began);
+#endif
                 return true;
             }
 
+            /**
+             * @brief Get the earliest time at which any managed object may have work to do
+             * @return uint64_t Absolute uptimeMicros() time, 0 if something is runnable now,
+             * NEVER if every object waits for an event
+             *
+             * @details Covers queued timers, polled Tasks, Chains (DELAY and INTERR timeouts)
+             * and nested executors.
+             */
+            uint64_t wakeTime() override {
+                if(!wakes.empty()) {
+                    return 0;
+                }
+
+                uint64_t next = timers.nextDue();
+
+                for(int level = PRIORITY_LOW; level <= PRIORITY_HIGH; level++) {
+                    if(!added[level].empty() || !due[level].empty()) {
+                        return 0;
+                    }
+
+                    for(Tick * tick = list[level].first(); tick != nullptr && next > 0; tick = TickList::next(tick)) {
+                        uint64_t time = tick->wakeTime();
+
+                        if(time < next) {
+                            next = time;
+                        }
+                    }
+                }
+
+                return next;
+            }
+
+            /**
+             * @brief Get the time until the earliest pending deadline
+             * @return uint64_t Milliseconds the loop may idle, 0 if something is runnable now
+             * or due in less than a millisecond, NEVER if every object waits for an event
+             */
+            uint64_t idleTime() {
+                uint64_t next = wakeTime();
+
+                if(next == NEVER) {
+                    return NEVER;
+                }
+
+                uint64_t now = uptimeMicros();
+                return next > now ? (next - now) / 1000 : 0;
+            }
+
+            /**
+             * @brief Idle until the earliest pending deadline or until an event wakes the loop
+             * @return bool True if woken by an event such as an ISR demand(), false otherwise
+             *
+             * @details Typical use is calling tick() and sleep() alternately from loop().
+             * Wakeups that arrive while tick() is running are not lost, the following
+             * sleep() returns immediately.
+             */
+            bool sleep() {
+                uint64_t idle = idleTime();
+
+                if(idle == 0) {
+                    return false;
+                }
+
+                return this->sleeper.wait(idle == NEVER ? Sleep::FOREVER : idle);
+            }
+
+            /**
+             * @brief Tick and sleep in a loop until stop() is called
+             */
+            void run() {
+                this->running = true;
+
+                while(this->running) {
+                    tick();
+
+                    if(this->running) {
+                        sleep();
+                    }
+                }
+            }
+
+            /**
+             * @brief Make run() return after the current iteration
+             * @note Safe to call from a Task callback, an interrupt or another thread
+             */
+            void stop() {
+                this->running = false;
+                this->sleeper.wake();
+            }
+
+            /**
+             * @brief Get the number of managed Tick objects
+             * @return size_t Objects in the polling list plus queued timers and parked objects
+             */
+            size_t size() {
+                size_t count = timers.size() + parked.size();
+
+                for(int level = PRIORITY_LOW; level <= PRIORITY_HIGH; level++) {
+                    count += list[level].size() + added[level].size() + due[level].size();
+                }
+
+                return count;
+            }
+
+            /**
+             * @brief Limit the time one tick() may spend dispatching
+             * @param us Budget in microseconds, 0 (default) for no limit
+             *
+             * @details The budget is checked between dispatched objects, so a single long
+             * callback still runs to completion, and every pass runs at least one object.
+             * Once it is spent the pass ends and
+             * the remaining, lower-priority work is deferred to the next pass.
+             */
+            void setBudget(uint32_t us) {
+                this->budget = us;
+            }
+
+            /**
+             * @brief Run expired timers of every priority level first, ordered by deadline
+             * @param enabled True for earliest-deadline-first, false (default) to order
+             * expired timers by priority first
+             *
+             * @note Only affects TIMERS mode, polled objects are always ordered by priority
+             */
+            void setDeadlineFirst(bool enabled) {
+                this->deadlineFirst = enabled;
+            }
+
+            /**
+             * @brief Number of passes that ended early because the budget was spent
+             * @return uint32_t Deferral count
+             */
+            uint32_t getDeferrals() {
+                return this->deferrals;
+            }
+
+#if ASYNC_STATS
+            /**
+             * @brief Call a function for every managed Tick object
+             * @param func Callable taking a Tick*, must not add or remove objects
+             */
+            template<typename Func>
+            void forEach(Func func) {
+                for(int level = PRIORITY_LOW; level <= PRIORITY_HIGH; level++) {
+                    TickList * lists[] = { &list[level], &added[level], &due[level] };
+
+                    for(TickList * from : lists) {
+                        for(Tick * tick = from->first(); tick != nullptr; tick = TickList::next(tick)) {
+                            func(tick);
+                        }
+                    }
+                }
+
+                for(size_t i=0; i < timers.size(); i++) {
+                    func(timers.at(i));
+                }
+
+                for(Tick * tick = parked.first(); tick != nullptr; tick = TickList::next(tick)) {
+                    func(tick);
+                }
+            }
+
+            /**
+             * @brief Get the loop counters
+             * @return const ExecutorStats& Pass count, busy time and tick() duration histogram
+             */
+            const ExecutorStats & getStats() {
+                return this->stats;
+            }
+
+            /**
+             * @brief Clear the loop counters and the counters of every managed Tick
+             */
+            void resetStats() {
+                this->stats = ExecutorStats();
+                this->stats.since = uptimeMicros();
+                forEach([](Tick * tick) { tick->getStats() = TickStats(); });
+            }
+
+            /**
+             * @brief Print the loop counters and one line per managed Tick
+             * @param out Destination, e.g. Serial
+             */
+            void report(Print & out) {
+                uint64_t now = uptimeMicros();
+
+                out.printf("executor passes=%u hz=%u idle=%u%% max_us=%u\n",
+                    this->stats.passes, this->stats.loopFrequency(now),
+                    (unsigned) (this->stats.idleRatio(now) * 100), this->stats.maxMicros);
+
+                forEach([&out](Tick * tick) {
+                    const TickStats & counters = tick->getStats();
+                    out.printf("  %-16s runs=%u avg_us=%u max_us=%u late_avg_us=%u late_max_us=%u\n",
+                        tick->getName(), counters.runs, counters.averageMicros(), counters.maxMicros,
+                        counters.averageLateMicros(), counters.maxLateMicros);
+                });
+            }
+#endif
+
             ///@name Task Creation Methods
             ///@{
 
@@ -87,7 +634,7 @@ namespace async {
              * @return Task* Pointer to the created Task object
              */
             Task * onTick(VoidCallback cb) {
-                auto task = new Task(Task::TICK, cb);
+                auto task = new Task(Task::TICK, std::move(cb));
                 this->add(task);
                 return task;
             }
@@ -99,7 +646,7 @@ namespace async {
              * @return Task* Pointer to the created Task object
              */
             Task * onRepeat(Duration * duration, VoidCallback cb) {
-                auto task = new Task(Task::REPEAT, duration, cb);
+                auto task = new Task(Task::REPEAT, duration, std::move(cb));
                 this->add(task);
                 return task;
             }
@@ -111,7 +658,21 @@ namespace async {
              * @return Task* Pointer to the created Task object
              */
             Task * onRepeat(uint64_t duration, VoidCallback cb) {
-                return onRepeat(new Duration(duration), cb);
+                auto task = new Task(Task::REPEAT, duration, std::move(cb));
+                this->add(task);
+                return task;
+            }
+
+            /**
+             * @brief Create and add a repeating task with its own copy of the interval
+             * @param duration Repeat interval, e.g. Duration::us(500)
+             * @param cb Callback function to execute
+             * @return Task* Pointer to the created Task object
+             */
+            Task * onRepeat(Duration duration, VoidCallback cb) {
+                auto task = new Task(Task::REPEAT, duration, std::move(cb));
+                this->add(task);
+                return task;
             }
 
             /**
@@ -121,7 +682,7 @@ namespace async {
              * @return Task* Pointer to the created Task object
              */
             Task * onDelay(Duration * duration, VoidCallback cb) {
-                auto task = new Task(Task::DELAY, duration, cb);
+                auto task = new Task(Task::DELAY, duration, std::move(cb));
                 this->add(task);
                 return task;
             }
@@ -133,7 +694,21 @@ namespace async {
              * @return Task* Pointer to the created Task object
              */
             Task * onDelay(uint64_t duration, VoidCallback cb) {
-                return onDelay(new Duration(duration), cb);
+                auto task = new Task(Task::DELAY, duration, std::move(cb));
+                this->add(task);
+                return task;
+            }
+
+            /**
+             * @brief Create and add a delayed one-time task with its own copy of the delay
+             * @param duration Delay time, e.g. Duration::us(500)
+             * @param cb Callback function to execute
+             * @return Task* Pointer to the created Task object
+             */
+            Task * onDelay(Duration duration, VoidCallback cb) {
+                auto task = new Task(Task::DELAY, duration, std::move(cb));
+                this->add(task);
+                return task;
             }
             
             /**
@@ -144,7 +719,7 @@ namespace async {
              * @note Demand tasks only execute when manually triggered
              */
             Task * onDemand(VoidCallback cb) {
-                auto task = new Task(Task::DEMAND, cb);
+                auto task = new Task(Task::DEMAND, std::move(cb));
                 this->add(task);
                 return task;
             }
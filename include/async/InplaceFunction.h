@@ -0,0 +1,199 @@
+#pragma once
+#include <async/Config.h>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @file InplaceFunction.h
+ * @brief Defines the async::InplaceFunction move-only callback type.
+ */
+
+namespace async {
+    template<typename Signature, size_t Capacity = ASYNC_CALLBACK_SIZE>
+    class InplaceFunction;
+
+    /**
+     * @class InplaceFunction
+     * @brief Move-only type-erased callable stored in a fixed inline buffer
+     *
+     * @details Unlike std::function, the callable (e.g. a capturing lambda) is always
+     * constructed inside the object itself, so registering and invoking a callback never
+     * touches the allocator. Callables larger than the buffer are rejected at compile
+     * time, unless ASYNC_CALLBACK_HEAP is enabled, in which case they are moved to the heap.
+     *
+     * Calling an empty InplaceFunction returns a value-initialized result.
+     *
+     * @tparam Result Return type
+     * @tparam Args Argument types
+     * @tparam Capacity Inline buffer size in bytes (default ASYNC_CALLBACK_SIZE)
+     */
+    template<typename Result, typename... Args, size_t Capacity>
+    class InplaceFunction<Result(Args...), Capacity> {
+        private:
+            /**
+             * @brief Operations of the stored callable type
+             */
+            struct Operations {
+                Result (*invoke)(void * storage, Args... args); ///< Call the callable
+                void (*move)(void * to, void * from);          ///< Move-construct into another buffer
+                void (*destroy)(void * storage);               ///< Destroy the callable
+            };
+
+            /**
+             * @brief Operations for a callable stored inline
+             */
+            template<typename Func>
+            struct Inline {
+                static Result invoke(void * storage, Args... args) {
+                    return (*static_cast<Func *>(storage))(std::forward<Args>(args)...);
+                }
+
+                static void move(void * to, void * from) {
+                    new (to) Func(std::move(*static_cast<Func *>(from)));
+                    static_cast<Func *>(from)->~Func();
+                }
+
+                static void destroy(void * storage) {
+                    static_cast<Func *>(storage)->~Func();
+                }
+
+                static const Operations * operations() {
+                    static const Operations ops = { invoke, move, destroy };
+                    return &ops;
+                }
+            };
+
+            /**
+             * @brief Operations for a callable stored on the heap (ASYNC_CALLBACK_HEAP)
+             */
+            template<typename Func>
+            struct Heap {
+                static Result invoke(void * storage, Args... args) {
+                    return (**static_cast<Func **>(storage))(std::forward<Args>(args)...);
+                }
+
+                static void move(void * to, void * from) {
+                    *static_cast<Func **>(to) = *static_cast<Func **>(from);
+                }
+
+                static void destroy(void * storage) {
+                    delete *static_cast<Func **>(storage);
+                }
+
+                static const Operations * operations() {
+                    static const Operations ops = { invoke, move, destroy };
+                    return &ops;
+                }
+            };
+
+            template<typename Func>
+            struct FitsSize {
+                static const bool value = sizeof(Func) <= Capacity
+                    && alignof(Func) <= alignof(std::max_align_t);
+            };
+
+            template<typename Func>
+            struct FitsInline {
+                static const bool value = FitsSize<Func>::value
+                    && std::is_nothrow_move_constructible<Func>::value;
+            };
+
+            alignas(std::max_align_t) mutable unsigned char storage[Capacity]; ///< Callable storage
+            const Operations * ops = nullptr; ///< Operations of the stored callable, nullptr if empty
+
+            template<typename Func>
+            void assign(Func && func, std::true_type) {
+                typedef typename std::decay<Func>::type Decayed;
+                new (storage) Decayed(std::forward<Func>(func));
+                ops = Inline<Decayed>::operations();
+            }
+
+            template<typename Func>
+            void assign(Func && func, std::false_type) {
+                typedef typename std::decay<Func>::type Decayed;
+                static_assert(ASYNC_CALLBACK_HEAP || !FitsSize<Decayed>::value,
+                    "Callable may throw when moved (e.g. it captures a String), InplaceFunction needs a noexcept move constructor or ASYNC_CALLBACK_HEAP");
+                static_assert(ASYNC_CALLBACK_HEAP || FitsSize<Decayed>::value,
+                    "Callable does not fit into InplaceFunction, increase ASYNC_CALLBACK_SIZE or enable ASYNC_CALLBACK_HEAP");
+                *reinterpret_cast<Decayed **>(storage) = new Decayed(std::forward<Func>(func));
+                ops = Heap<Decayed>::operations();
+            }
+
+            void reset() {
+                if(ops != nullptr) {
+                    ops->destroy(storage);
+                    ops = nullptr;
+                }
+            }
+
+        public:
+            InplaceFunction() {}
+
+            InplaceFunction(decltype(nullptr)) {}
+
+            /**
+             * @brief Store a callable
+             * @param func Function object, lambda or function pointer
+             */
+            template<typename Func, typename = typename std::enable_if<
+                !std::is_same<typename std::decay<Func>::type, InplaceFunction>::value>::type>
+            InplaceFunction(Func && func) {
+                typedef typename std::decay<Func>::type Decayed;
+                assign(std::forward<Func>(func), std::integral_constant<bool, FitsInline<Decayed>::value>());
+            }
+
+            InplaceFunction(InplaceFunction && other) noexcept {
+                if(other.ops != nullptr) {
+                    other.ops->move(storage, other.storage);
+                    ops = other.ops;
+                    other.ops = nullptr;
+                }
+            }
+
+            InplaceFunction(const InplaceFunction &) = delete;
+            InplaceFunction & operator=(const InplaceFunction &) = delete;
+
+            ~InplaceFunction() {
+                reset();
+            }
+
+            InplaceFunction & operator=(InplaceFunction && other) noexcept {
+                if(this != &other) {
+                    reset();
+
+                    if(other.ops != nullptr) {
+                        other.ops->move(storage, other.storage);
+                        ops = other.ops;
+                        other.ops = nullptr;
+                    }
+                }
+                return *this;
+            }
+
+            InplaceFunction & operator=(decltype(nullptr)) {
+                reset();
+                return *this;
+            }
+
+            /**
+             * @brief Invoke the stored callable
+             * @param args Call arguments
+             * @return Result of the call, or a value-initialized Result if empty
+             */
+            Result operator()(Args... args) const {
+                if(ops == nullptr) {
+                    return Result();
+                }
+                return ops->invoke(storage, std::forward<Args>(args)...);
+            }
+
+            /**
+             * @brief Check whether a callable is stored
+             */
+            explicit operator bool() const {
+                return ops != nullptr;
+            }
+    };
+}
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <Arduino.h>
+#include <async/Config.h>
 #include <async/Time.h>
+#include <type_traits>
 
 /**
  * @file
@@ -17,18 +19,212 @@
 #define __FILENAME__ (strrchr(__FILE__, '\\') ? strrchr(__FILE__, '\\') + 1 : __FILE__)
 #endif
 
+namespace async {
+    class Task;
+
+    /**
+     * @brief FNV-1a hash of a string, usable in constant expressions
+     * @param text Null-terminated string
+     * @param hash Hash of the preceding characters
+     * @return uint32_t 32-bit hash
+     *
+     * @note Identifies interned format strings and file names; tools/log_decode.py
+     * computes the same hash.
+     */
+    constexpr uint32_t logHash(char const * text, uint32_t hash = 2166136261u) {
+        return *text ? logHash(text + 1, (hash ^ (uint8_t) *text) * 16777619u) : hash;
+    }
+
+    /**
+     * @brief File name part of a path, usable in constant expressions
+     * @param path Path with '/' or '\\' separators
+     * @param base Start of the current file name candidate
+     * @return char const* Pointer to the file name in path
+     */
+    constexpr char const * logBasename(char const * path, char const * base = nullptr) {
+        return *path ? logBasename(path + 1, (*path == '/' || *path == '\\') ? path + 1 : (base ? base : path)) : (base ? base : path);
+    }
+
+    /**
+     * @class LogLine
+     * @brief Writes one interned log line
+     *
+     * @details The line is "~<timestamp> <core><level> <file id> <format id>" followed by
+     * the arguments: numbers in decimal, strings as "<length>:<bytes>". The format string
+     * itself never reaches the binary.
+     */
+    class LogLine {
+        private:
+            char buf[256];  ///< Line being written
+            size_t at;      ///< Characters used in buf
+
+            void append(char const * format, ...);
+
+        public:
+            LogLine(int level, uint32_t file, uint32_t id);
+
+            LogLine & operator<<(int value);
+            LogLine & operator<<(unsigned int value);
+            LogLine & operator<<(long value);
+            LogLine & operator<<(unsigned long value);
+            LogLine & operator<<(long long value);
+            LogLine & operator<<(unsigned long long value);
+            LogLine & operator<<(double value);
+            LogLine & operator<<(long double value);
+            LogLine & operator<<(char const * value);
+            LogLine & operator<<(void const * value);
+
+            /**
+             * @brief Write the line to Serial
+             */
+            void end();
+    };
+
+    /**
+     * @class Log
+     * @brief Runtime level filtering and control of the deferred logging mode
+     *
+     * @details Messages below the level of their file are dropped before any argument is
+     * formatted or copied. Levels for single files override the global level in both
+     * directions, so one file can log at debug level while the rest only warns.
+     *
+     * With ASYNC_LOG_DEFERRED enabled, log() no longer formats and prints the
+     * line itself. It only copies the format pointer, level, timestamp and raw argument
+     * values (plus a truncated copy of string arguments) into a lock-free queue, which
+     * takes a few microseconds. The lines are formatted and written later by drain(),
+     * usually from a low-priority Task or a worker on the other core. When the queue is
+     * full the message is dropped and counted.
+     *
+     * @note Format strings must stay valid until drained, which string literals do.
+     * At most ASYNC_LOG_MAX_ARGS arguments are captured, "%n" is not supported.
+     */
+    class Log {
+        public:
+            ///@name Level Constants
+            ///@{
+            static int const LEVEL_TRACE = 0;
+            static int const LEVEL_DEBUG = 1;
+            static int const LEVEL_INFO = 2;
+            static int const LEVEL_WARN = 3;
+            static int const LEVEL_ERROR = 4;
+            ///@}
+
+            /**
+             * @brief Set the level of every file without its own level
+             * @param level Lowest level that is written
+             */
+            static void setLevel(int level);
+
+            /**
+             * @brief Set the level of one source file
+             * @param file File name, e.g. "Main.cpp", matched against the end of the path
+             * @param level Lowest level written for that file
+             * @return bool False if all ASYNC_LOG_FILE_LEVELS slots are used
+             *
+             * @note Meant for setup(), not to be called while other cores are logging
+             */
+            static bool setLevel(char const * file, int level);
+
+            /**
+             * @brief Check whether a message passes the runtime level
+             * @param level Message level
+             * @param file Source file of the message
+             * @return true if the message should be written
+             */
+            static bool enabled(int level, char const * file);
+
+            /**
+             * @brief Check whether an interned message passes the runtime level
+             * @param level Message level
+             * @param file logHash() of the file name
+             * @return true if the message should be written
+             */
+            static bool enabled(int level, uint32_t file);
+
+            /**
+             * @brief Format and write queued messages
+             * @param max Maximum number of messages to write
+             * @return size_t Number of messages written, always 0 in immediate mode
+             *
+             * @note Only one context may drain at a time
+             */
+            static size_t drain(size_t max = (size_t) -1);
+
+            /**
+             * @brief Number of messages lost because the queue was full
+             * @return uint32_t Dropped message count
+             */
+            static uint32_t dropped();
+
+            /**
+             * @brief Create a low-priority Task that drains the queue
+             * @param batch Messages written per run, bounds the time spent per pass
+             * @return Task* Task to add to an Executor, or to a worker of a MultiExecutor
+             *
+             * @details A DEMAND task: the first message after a drain demands it, so it
+             * costs nothing per pass and lets Executor::sleep() idle while nothing is
+             * logged. Only one drain task is signalled, the last one created.
+             */
+            static Task * drainTask(size_t batch = 4);
+    };
+}
+
 /**
  * @brief Base logging function
  * @param level Log level (0=trace, 1=debug, 2=info, 3=warn, 4=error)
  * @param format Format string (printf-style)
  * @param file Source file name where the log originated
  * @param ... Variable arguments for the format string
- * 
+ *
  * @note This is the underlying function used by all logging macros
  * @note Actual implementation should be provided elsewhere
  */
 void log(int level, char const * format, char const * file, ...);
 
+/**
+ * @brief Interned logging function used by the macros with ASYNC_LOG_INTERN
+ * @param level Log level (0=trace, 1=debug, 2=info, 3=warn, 4=error)
+ * @param file logHash() of the source file name
+ * @param id logHash() of the format string
+ * @param args Arguments of the format string
+ */
+template<typename... Args>
+void logInterned(int level, uint32_t file, uint32_t id, Args const &... args) {
+    if(!async::Log::enabled(level, file)) {
+        return;
+    }
+
+    async::LogLine line(level, file, id);
+    int expand[] = {0, ((void) (line << args), 0)...};
+    (void) expand;
+    line.end();
+}
+
+#if ASYNC_LOG_INTERN
+/**
+ * @brief Compile-time ID of a format string literal
+ */
+#define ASYNC_LOG_ID(text) (std::integral_constant<uint32_t, async::logHash(text)>::value)
+
+#define ASYNC_LOG(level, format, ...) logInterned(level, \
+    ASYNC_LOG_ID(async::logBasename(__FILE__)), ASYNC_LOG_ID(format), ##__VA_ARGS__)
+#else
+#define ASYNC_LOG(level, format, ...) log(level, format, __FILENAME__, ##__VA_ARGS__)
+#endif
+
+namespace async {
+    /**
+     * @brief Stand-in for a disabled log call, only named in unevaluated operands
+     *
+     * @details Disabled macros pass their arguments here inside sizeof(), so variables
+     * that are only logged still count as used and nothing is evaluated or emitted.
+     */
+    template<typename... Args>
+    int logDiscard(char const * format, Args const &... args);
+}
+
+#define ASYNC_LOG_DISCARD(format, ...) ((void) sizeof(async::logDiscard(format, ##__VA_ARGS__)))
+
 ///@name Logging Macros
 ///@{
 
@@ -36,45 +232,65 @@ void log(int level, char const * format, char const * file, ...);
  * @brief Log a TRACE level message
  * @param format Format string (printf-style)
  * @param ... Variable arguments for the format string
- * 
+ *
  * @note Level 0 - Most verbose, for detailed execution tracing
  */
-#define trace(format, ...) log(0, format, __FILENAME__, ##__VA_ARGS__)
+#if ASYNC_LOG_LEVEL <= 0
+#define trace(format, ...) ASYNC_LOG(0, format, ##__VA_ARGS__)
+#else
+#define trace(format, ...) ASYNC_LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
 
 /**
  * @brief Log a DEBUG level message
  * @param format Format string (printf-style)
  * @param ... Variable arguments for the format string
- * 
+ *
  * @note Level 1 - Debug information for development
  */
-#define debug(format, ...) log(1, format, __FILENAME__, ##__VA_ARGS__)
+#if ASYNC_LOG_LEVEL <= 1
+#define debug(format, ...) ASYNC_LOG(1, format, ##__VA_ARGS__)
+#else
+#define debug(format, ...) ASYNC_LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
 
 /**
  * @brief Log an INFO level message
  * @param format Format string (printf-style)
  * @param ... Variable arguments for the format string
- * 
+ *
  * @note Level 2 - General operational information
  */
-#define info(format, ...) log(2, format, __FILENAME__, ##__VA_ARGS__)
+#if ASYNC_LOG_LEVEL <= 2
+#define info(format, ...) ASYNC_LOG(2, format, ##__VA_ARGS__)
+#else
+#define info(format, ...) ASYNC_LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
 
 /**
  * @brief Log a WARNING level message
  * @param format Format string (printf-style)
  * @param ... Variable arguments for the format string
- * 
+ *
  * @note Level 3 - Indicates potential issues
  */
-#define warn(format, ...) log(3, format, __FILENAME__, ##__VA_ARGS__)
+#if ASYNC_LOG_LEVEL <= 3
+#define warn(format, ...) ASYNC_LOG(3, format, ##__VA_ARGS__)
+#else
+#define warn(format, ...) ASYNC_LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
 
 /**
  * @brief Log an ERROR level message
  * @param format Format string (printf-style)
  * @param ... Variable arguments for the format string
- * 
+ *
  * @note Level 4 - Serious problems that need attention
  */
-#define error(format, ...) log(4, format, __FILENAME__, ##__VA_ARGS__)
+#if ASYNC_LOG_LEVEL <= 4
+#define error(format, ...) ASYNC_LOG(4, format, ##__VA_ARGS__)
+#else
+#define error(format, ...) ASYNC_LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
 
-///@}
\ No newline at end of file
+///@}
@@ -0,0 +1,109 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @file MpscQueue.h
+ * @brief Defines the async::MpscQueue multi-producer/single-consumer queue.
+ */
+
+namespace async {
+    /**
+     * @class MpscQueue
+     * @brief Lock-free bounded queue for many producers and one consumer
+     *
+     * @details Every slot carries a sequence number that tells producers and the
+     * consumer whether it is free or filled (Vyukov's bounded queue). Producers claim a
+     * slot with one compare-and-swap, so tasks on both cores and interrupts can push
+     * concurrently without locks. A full queue rejects new elements.
+     *
+     * @tparam T Element type, copied in and out
+     * @tparam N Capacity, must be a power of two
+     *
+     * @note Only one context may call pop().
+     */
+    template<typename T, size_t N>
+    class MpscQueue {
+        static_assert(N > 0 && (N & (N - 1)) == 0, "MpscQueue capacity must be a power of two");
+
+        private:
+            struct Cell {
+                std::atomic<uint32_t> sequence; ///< Slot state relative to the queue positions
+                T item;                         ///< Stored element
+            };
+
+            Cell cells[N];                  ///< Slot storage
+            std::atomic<uint32_t> head;     ///< Next position to claim, shared by producers
+            uint32_t tail = 0;              ///< Next position to read, owned by the consumer
+
+        public:
+            MpscQueue() : head(0) {
+                for(size_t i=0; i < N; i++) {
+                    cells[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            /**
+             * @brief Append an element (any producer)
+             * @param item Element to copy into the queue
+             * @return true if stored, false if the queue is full
+             */
+            bool push(const T & item) {
+                uint32_t position = head.load(std::memory_order_relaxed);
+
+                while(true) {
+                    Cell & cell = cells[position & (N - 1)];
+                    int32_t diff = (int32_t) (cell.sequence.load(std::memory_order_acquire) - position);
+
+                    if(diff == 0) {
+                        if(head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                            cell.item = item;
+                            cell.sequence.store(position + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if(diff < 0) {
+                        return false;
+                    }
+                    else {
+                        position = head.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            /**
+             * @brief Remove the oldest element (consumer side)
+             * @param[out] item Receives the element
+             * @return true if an element was removed, false if the queue is empty
+             */
+            bool pop(T & item) {
+                Cell & cell = cells[tail & (N - 1)];
+
+                if(cell.sequence.load(std::memory_order_acquire) != tail + 1) {
+                    return false;
+                }
+
+                item = cell.item;
+                cell.sequence.store(tail + N, std::memory_order_release);
+                tail++;
+                return true;
+            }
+
+            /**
+             * @brief Check whether the queue is empty (consumer side)
+             * @return true if no element is ready to be popped
+             */
+            bool empty() const {
+                return cells[tail & (N - 1)].sequence.load(std::memory_order_acquire) != tail + 1;
+            }
+
+            /**
+             * @brief Number of elements the queue can hold
+             * @return size_t Queue capacity
+             */
+            size_t capacity() const {
+                return N;
+            }
+    };
+}
@@ -0,0 +1,210 @@
+#pragma once
+#include <Arduino.h>
+#include <async/Task.h>
+#include <async/Tick.h>
+#include <async/Callbacks.h>
+#include <async/TickList.h>
+#include <async/Config.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#if defined(ARDUINO_ARCH_ESP32)
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/task.h>
+#elif !defined(ARDUINO)
+    #include <thread>
+#endif
+
+/**
+ * @file MultiExecutor.h
+ * @brief Defines the async::MultiExecutor work-stealing scheduler for multi-core targets.
+ */
+
+#if defined(ARDUINO_ARCH_ESP32) || !defined(ARDUINO)
+namespace async {
+    /**
+     * @class MultiExecutor
+     * @brief Runs Tick objects on several workers, one run queue per worker
+     *
+     * @details Worker 0 runs in the context that calls tick(), normally the Arduino
+     * loop(). Every other worker runs in its own thread created by start(); on the ESP32
+     * worker i is a FreeRTOS task pinned to the i-th core after the one calling start(),
+     * so with two workers started from loop() (core 1), worker 1 runs on core 0.
+     *
+     * Each worker polls its own queue in passes and runs the objects whose wakeTime()
+     * has passed, each at most once per pass. A worker that finds nothing to run steals
+     * a runnable object from a worker that is busy running something else; the stolen
+     * object then stays with its new worker. Objects pinned with Tick::setAffinity()
+     * are never stolen.
+     *
+     * An object is only ever ticked by one worker at a time, but its callbacks may run
+     * on different cores over its lifetime unless it is pinned. Ticks that share data
+     * must either be pinned to the same worker or synchronize that data themselves.
+     *
+     * @note Every worker has its own lock, taken for queue operations only; tick() calls
+     * run without it. Stealing takes the locks of the two workers involved.
+     */
+    class MultiExecutor : public Tick {
+        private:
+            /**
+             * @brief Run queue and thread of one worker
+             */
+            struct Worker {
+                MultiExecutor * owner;       ///< Scheduler the worker belongs to
+                int index;                   ///< Worker index
+                std::mutex lock;             ///< Guards the lists and the current Tick
+                TickList list;               ///< Ticks not visited yet in the current pass
+                TickList visited;            ///< Ticks run or skipped in the current pass
+                Tick * current = nullptr;    ///< Tick being run by the worker
+                bool currentRemoved = false; ///< remove() was called for the current Tick
+#if defined(ARDUINO_ARCH_ESP32)
+                TaskHandle_t handle = nullptr;
+#else
+                std::thread thread;
+#endif
+            };
+
+            std::vector<Worker*> workers;  ///< Workers, workers[0] is driven by tick()
+            std::atomic<bool> running;     ///< Background workers keep looping while set
+            std::atomic<int> alive;        ///< Number of background workers still looping
+            std::atomic<uint32_t> stolen;  ///< Number of successful steals
+            bool begin = false;
+
+            void destroy(Tick * tick);
+            Tick * take(Worker & self, uint64_t now);
+            Tick * steal(Worker & victim, uint64_t now);
+            bool step(Worker & self, bool stealing);
+            void endPass(Worker & self);
+            static void work(void * arg);
+
+        public:
+            /**
+             * @brief Create a scheduler
+             * @param count Number of workers, including the one driven by tick()
+             */
+            MultiExecutor(int count = 2);
+
+            /**
+             * @brief Stop the background workers, cancel and delete the managed Ticks
+             *
+             * @note Objects that are not owned (see Tick::setOwned()) are only cancelled
+             */
+            ~MultiExecutor();
+
+            /**
+             * @brief Start the managed Ticks and launch the background workers
+             * @return bool Always true
+             */
+            bool start() override;
+
+            /**
+             * @brief Stop the background workers and wait until they have left their loop
+             * @return bool Always true
+             */
+            bool stop();
+
+            /**
+             * @brief Add a Tick object
+             * @param tick Pointer to the Tick object
+             *
+             * @details Pinned objects go to their worker, the others to the worker with the
+             * shortest queue. Safe to call from any worker or thread.
+             */
+            void add(Tick * tick);
+
+            /**
+             * @brief Remove and delete a Tick object
+             * @param tick Pointer to the Tick object
+             *
+             * @note A Tick that is running is deleted once its tick() has returned
+             */
+            void remove(Tick * tick);
+
+            /**
+             * @brief Run worker 0 for one pass
+             * @return bool Always true
+             *
+             * @details Runs every runnable object of worker 0 once, or steals one object
+             * from a busy worker if worker 0 has nothing to do. Objects added or stolen
+             * during the pass may run in it as well.
+             */
+            bool tick() override;
+
+            /**
+             * @brief Get the earliest wakeTime() of the objects owned by worker 0
+             * @return uint64_t Absolute uptimeMicros() time, 0 if something is runnable now
+             */
+            uint64_t wakeTime() override;
+
+            /**
+             * @brief Number of workers
+             * @return int Worker count
+             */
+            int workerCount() {
+                return workers.size();
+            }
+
+            /**
+             * @brief Number of Ticks owned by a worker, running ones excluded
+             * @param worker Worker index
+             * @return size_t Queue size
+             */
+            size_t size(int worker);
+
+            /**
+             * @brief Number of objects that moved to another worker by stealing
+             * @return uint32_t Steal count
+             */
+            uint32_t steals() {
+                return stolen.load();
+            }
+
+            ///@name Task Factory Methods
+            ///@{
+
+            /**
+             * @brief Create and add a task executed on every pass of its worker
+             * @param cb Callback function to execute
+             * @param worker Worker to pin the task to, ANY to let it migrate
+             * @return Task* Pointer to the created Task object
+             */
+            Task * onTick(VoidCallback cb, int worker = ANY) {
+                auto task = new Task(Task::TICK, std::move(cb));
+                task->setAffinity(worker);
+                this->add(task);
+                return task;
+            }
+
+            /**
+             * @brief Create and add a repeating task with millisecond interval
+             * @param duration Repeat interval in milliseconds
+             * @param cb Callback function to execute
+             * @param worker Worker to pin the task to, ANY to let it migrate
+             * @return Task* Pointer to the created Task object
+             */
+            Task * onRepeat(uint64_t duration, VoidCallback cb, int worker = ANY) {
+                auto task = new Task(Task::REPEAT, duration, std::move(cb));
+                task->setAffinity(worker);
+                this->add(task);
+                return task;
+            }
+
+            /**
+             * @brief Create and add a delayed one-time task with millisecond delay
+             * @param duration Delay time in milliseconds
+             * @param cb Callback function to execute
+             * @param worker Worker to pin the task to, ANY to let it migrate
+             * @return Task* Pointer to the created Task object
+             */
+            Task * onDelay(uint64_t duration, VoidCallback cb, int worker = ANY) {
+                auto task = new Task(Task::DELAY, duration, std::move(cb));
+                task->setAffinity(worker);
+                this->add(task);
+                return task;
+            }
+
+            ///@}
+    };
+}
+#endif
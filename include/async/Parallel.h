@@ -0,0 +1,318 @@
+#pragma once
+#include <Arduino.h>
+#include <async/Tick.h>
+#include <async/Duration.h>
+#include <async/InplaceFunction.h>
+#include <async/WakeQueue.h>
+#include <initializer_list>
+#include <vector>
+
+/**
+ * @file Parallel.h
+ * @brief Defines async::Parallel, the all(), race() and withTimeout() combinators.
+ */
+
+namespace async {
+    /**
+     * @class Parallel
+     * @brief Runs several Tick objects side by side and finishes when they are done
+     *
+     * @details The children are driven from the combinator's own tick(), so a group
+     * added to an executor progresses on the same pass as everything else. A child is
+     * done when its tick() returns false, like it would be for an executor; Chain,
+     * CoroutineTick and one-shot Tasks qualify.
+     *
+     * - all() finishes when every child is done
+     * - race() finishes when the first child is done and cancels the others
+     * - withTimeout() runs one child and cancels it when the time is up
+     *
+     * Every group takes an optional timeout() and a then() callback, which receives the
+     * index of the child whose completion finished the group (the winner of a race, the
+     * last child of all()), or TIMEOUT. Cancelled children are cancel()ed and deleted
+     * right away.
+     *
+     * A child's wake() is routed to the group, so the group reports the earliest
+     * deadline() of its children or its timeout and an executor keeps it parked or in
+     * its timer queue while the children wait.
+     *
+     * @code
+     * executor.add(race(sensorA, sensorB)->timeout(500)->then([](int winner) {
+     *     info("first answer from %d", winner);
+     * }));
+     * @endcode
+     *
+     * @note The group owns its children, they must be heap allocated and not be added to
+     * an executor themselves
+     */
+    class Parallel : public Tick {
+        public:
+            typedef InplaceFunction<void(int)> ResultCallback;
+
+            static int const ALL = 0;       ///< Wait for every child
+            static int const RACE = 1;      ///< Wait for the first child
+            static int const TIMEOUT = -1;  ///< Result when the timeout expired first
+
+        private:
+            std::vector<Tick *> children;   ///< Running children, nullptr once done
+            ResultCallback callback;
+            WakeQueue wakes;                ///< Collects the children's wake() calls and wakes the group
+            uint64_t duration = NEVER;      ///< Timeout in microseconds, NEVER for none
+            uint64_t until = NEVER;         ///< Timeout time
+            int mode;
+            int running = 0;                ///< Number of children not done yet
+            int result = TIMEOUT;
+            bool started = false;           ///< start() ran, the children and timeout are armed
+            bool cancelled = false;
+
+            /**
+             * @brief Cancel and delete every child that is still running
+             */
+            void cancelChildren() {
+                for(size_t i=0; i < children.size(); i++) {
+                    if(children[i] != nullptr) {
+                        children[i]->cancel();
+                        drop(i);
+                    }
+                }
+
+                this->running = 0;
+            }
+
+            /**
+             * @brief Stop routing a child's wake() calls and delete it if owned
+             * @param index Index of a child that is still running
+             */
+            void drop(size_t index) {
+                Tick * child = children[index];
+                wakes.detach(child);
+
+                if(child->isOwned()) {
+                    delete child;
+                }
+
+                children[index] = nullptr;
+            }
+
+            /**
+             * @brief Finish the group
+             * @param result Index of the deciding child or TIMEOUT
+             * @return false, for tick() to hand back to the executor
+             */
+            bool finish(int result) {
+                cancelChildren();
+                this->result = result;
+
+                if(this->callback) {
+                    this->callback(result);
+                }
+
+                return false;
+            }
+
+        public:
+            /**
+             * @brief Create a group, see all(), race() and withTimeout()
+             * @param mode ALL or RACE
+             * @param children Heap allocated children, owned by the group
+             */
+            Parallel(int mode, std::initializer_list<Tick *> children) : children(children), wakes(this), mode(mode) {
+                for(size_t i=0; i < this->children.size(); i++) {
+                    if(this->children[i] != nullptr) {
+                        wakes.attach(this->children[i]);
+                        this->running++;
+                    }
+                }
+            }
+
+            ~Parallel() {
+                cancelChildren();
+            }
+
+            /**
+             * @brief Give up after a while
+             * @param ms Timeout in milliseconds, counted from start()
+             * @return Parallel* This group
+             */
+            Parallel * timeout(unsigned long ms) {
+                this->duration = (uint64_t) ms * 1000;
+                return this;
+            }
+
+            /**
+             * @brief Give up after a while, with microsecond resolution
+             * @param duration Timeout, counted from start()
+             * @return Parallel* This group
+             */
+            Parallel * timeout(Duration duration) {
+                this->duration = duration.get(Duration::MICRO);
+                return this;
+            }
+
+            /**
+             * @brief Set the callback run when the group finishes
+             * @param callback Receives the index of the deciding child, or TIMEOUT
+             * @return Parallel* This group
+             */
+            Parallel * then(ResultCallback callback) {
+                this->callback = std::move(callback);
+                return this;
+            }
+
+            /**
+             * @brief Get the outcome of a finished group
+             * @return int Index of the deciding child, TIMEOUT if the time ran out or the
+             * group has not finished
+             */
+            int getResult() {
+                return this->result;
+            }
+
+            /**
+             * @brief Start the children and arm the timeout
+             *
+             * @details Run by the first tick() if nobody called it before, e.g. for a group
+             * added to an executor that was not started yet.
+             */
+            bool start() override {
+                uint64_t now = uptimeMicros();
+                this->until = this->duration == NEVER ? NEVER : now + this->duration;
+                this->started = true;
+
+                for(size_t i=0; i < children.size(); i++) {
+                    if(children[i] != nullptr) {
+                        children[i]->start();
+                    }
+                }
+
+                return true;
+            }
+
+            bool cancel() override {
+                this->cancelled = true;
+                cancelChildren();
+                return true;
+            }
+
+            bool tick() override {
+                if(this->cancelled) {
+                    return false;
+                }
+
+                if(!this->started) {
+                    start();
+                }
+
+                if(this->running == 0) {
+                    return finish(TIMEOUT);
+                }
+
+                // Every running child is ticked below, the queue only carries the wakeup
+                wakes.drain([](Tick *) {});
+
+                for(size_t i=0; i < children.size(); i++) {
+                    Tick * child = children[i];
+
+                    if(child == nullptr || child->tick()) {
+                        continue;
+                    }
+
+                    drop(i);
+                    this->running--;
+
+                    if(this->mode == RACE || this->running == 0) {
+                        return finish((int) i);
+                    }
+                }
+
+                if(uptimeMicros() >= this->until) {
+                    return finish(TIMEOUT);
+                }
+
+                return true;
+            }
+
+            /**
+             * @brief Get the time at which the group needs its next tick
+             * @return uint64_t Earliest deadline() of the running children or the timeout,
+             * NEVER while every child waits for a wake() and no timeout is set, 0 before
+             * start() or once the group is done
+             */
+            uint64_t deadline() override {
+                if(this->cancelled || !this->started || this->running == 0) {
+                    return 0;
+                }
+
+                uint64_t next = this->until;
+
+                for(size_t i=0; i < children.size() && next > 0; i++) {
+                    if(children[i] != nullptr) {
+                        uint64_t time = children[i]->deadline();
+
+                        if(time < next) {
+                            next = time;
+                        }
+                    }
+                }
+
+                return next;
+            }
+
+            /**
+             * @brief Earliest wakeTime() of the running children, or the timeout
+             */
+            uint64_t wakeTime() override {
+                if(!this->started) {
+                    return 0;
+                }
+
+                uint64_t next = this->until;
+
+                for(size_t i=0; i < children.size() && next > 0; i++) {
+                    if(children[i] != nullptr) {
+                        uint64_t time = children[i]->wakeTime();
+
+                        if(time < next) {
+                            next = time;
+                        }
+                    }
+                }
+
+                return next;
+            }
+    };
+
+    ///@name Combinators
+    ///@{
+
+    /**
+     * @brief Run Tick objects side by side until all of them are done
+     * @param children Heap allocated Tick objects, e.g. chains
+     * @return Parallel* Group owned by the executor or Chain it is given to
+     */
+    template<typename... Ticks>
+    Parallel * all(Ticks *... children) {
+        return new Parallel(Parallel::ALL, { children... });
+    }
+
+    /**
+     * @brief Run Tick objects side by side until the first one is done
+     * @param children Heap allocated Tick objects, e.g. chains
+     * @return Parallel* Group owned by the executor or Chain it is given to
+     */
+    template<typename... Ticks>
+    Parallel * race(Ticks *... children) {
+        return new Parallel(Parallel::RACE, { children... });
+    }
+
+    /**
+     * @brief Run a Tick object for at most a while
+     * @param child Heap allocated Tick object
+     * @param ms Timeout in milliseconds
+     * @return Parallel* Group owned by the executor or Chain it is given to
+     */
+    inline Parallel * withTimeout(Tick * child, unsigned long ms) {
+        return (new Parallel(Parallel::RACE, { child }))->timeout(ms);
+    }
+
+    ///@}
+}
@@ -3,15 +3,39 @@
 #include <async/Callbacks.h>
 #include <async/Tick.h>
 #include <async/Task.h>
+#include <async/Config.h>
+#include <async/RingBuffer.h>
+#include <async/Sleep.h>
+#include <algorithm>
 #include <vector>
 
 /**
  * @brief Interrupt Service Routine for Pin interrupts.
- * @param arg Pointer to argument, typically a Task object.
+ * @param arg Pointer to the async::Pin that attached the interrupt.
  */
 IRAM_ATTR void ISR(void* arg);
 
 namespace async {
+    /**
+     * @brief Pin edge recorded by the interrupt handler
+     */
+    struct PinEvent {
+        int pin;       ///< Pin number
+        int level;     ///< Level read inside the ISR, HIGH for a rising edge
+        uint32_t time; ///< micros() at interrupt time
+    };
+
+    class Pin;
+
+    /**
+     * @brief Description of an edge to wait for, see Pin::edge()
+     */
+    struct PinEdge {
+        Pin * pin;              ///< Pin to watch
+        int edge;               ///< RISING or FALLING
+        unsigned long timeout;  ///< Timeout in milliseconds, 0xFFFFFFFF for none
+    };
+
     /**
      * @brief Asynchronous Pin class for handling digital/analog IO and interrupts.
      *
@@ -23,9 +47,14 @@ namespace async {
             int pin; ///< Pin number or interrupt number.
             int mode; ///< Pin mode (INPUT, OUTPUT, etc).
             int value; ///< Last written value.
-            Task * interruptTask; ///< Task triggered by pin interrupt.
+            RingBuffer<PinEvent, ASYNC_PIN_QUEUE_SIZE> events; ///< Edges queued by the ISR.
+            PinEvent current = { 0, LOW, 0 }; ///< Edge being dispatched to the handlers.
+            volatile uint32_t overflows = 0; ///< Edges dropped because the queue was full.
             std::vector<async::Task*> handlersRising; ///< Tasks for rising edge.
             std::vector<async::Task*> handlersFalling; ///< Tasks for falling edge.
+            uint32_t risingEdges = 0; ///< Rising edges dispatched so far.
+            uint32_t fallingEdges = 0; ///< Falling edges dispatched so far.
+            std::vector<Tick*> waiters; ///< Ticks woken when an edge is dispatched.
         public:
 
         /**
@@ -34,20 +63,7 @@ namespace async {
          * @param mode Pin mode (default INPUT_PULLUP).
          * @param val Initial value (default HIGH).
          */
-        Pin(int pin, int mode = INPUT_PULLUP, int val = HIGH): pin(digitalPinToInterrupt(pin)), mode(mode), value(val) {
-            interruptTask = new Task(Task::DEMAND, [this]() {
-                if(digitalRead() == HIGH) {
-                    for(int i=0; i < this->handlersRising.size(); i++) {
-                        handlersRising.at(i)->demand();
-                    }
-                }
-                else {
-                    for(int i=0; i < this->handlersFalling.size(); i++) {
-                        handlersFalling.at(i)->demand();
-                    }
-                }
-            });
-        };
+        Pin(int pin, int mode = INPUT_PULLUP, int val = HIGH): pin(digitalPinToInterrupt(pin)), mode(mode), value(val) {};
 
         /**
          * @brief Start the pin, setting its mode and initial value.
@@ -120,11 +136,13 @@ namespace async {
 
             if(mode == OUTPUT) {
                 detachInterrupt(pin);
+                Sleep::removeWakePin(pin);
                 pinMode(pin, mode);
             }
             else {
                 pinMode(pin, mode);
-                attachInterruptArg(pin, ISR, interruptTask, CHANGE);
+                attachInterruptArg(pin, ISR, this, CHANGE);
+                Sleep::addWakePin(pin, ISR, this);
             }
         }
 
@@ -150,7 +168,7 @@ namespace async {
          * @param callback Function to call.
          */
         void onInterrupt(int edge, VoidCallback callback) {
-            auto task = new Task(Task::DEMAND, callback);
+            auto task = new Task(Task::DEMAND, std::move(callback));
 
             if(edge == RISING) {
                 this->handlersRising.push_back(task);
@@ -170,12 +188,123 @@ namespace async {
             this->handlersFalling.erase(std::remove(this->handlersRising.begin(), this->handlersRising.end(), task));
         }
 
+        /**
+         * @brief Wake a Tick whenever an edge is dispatched
+         * @param tick Tick waiting for an edge, e.g. a chain step that reports no deadline
+         *
+         * @details The tick compares getEdgeCount() itself; remove it with removeWaiter()
+         * once it stops waiting.
+         */
+        void addWaiter(Tick * tick) {
+            if(std::find(this->waiters.begin(), this->waiters.end(), tick) == this->waiters.end()) {
+                this->waiters.push_back(tick);
+            }
+        }
+
+        /**
+         * @brief Stop waking a Tick added with addWaiter()
+         * @param tick Waiting tick
+         */
+        void removeWaiter(Tick * tick) {
+            this->waiters.erase(std::remove(this->waiters.begin(), this->waiters.end(), tick), this->waiters.end());
+        }
+
+        /**
+         * @brief Record an edge, called from the interrupt handler
+         *
+         * @details Queues the level and timestamp seen at interrupt time, so edges that
+         * arrive faster than the executor ticks are neither merged nor misclassified.
+         * When the queue is full the edge is dropped and counted in getOverflows().
+         */
+        void interrupt();
+
+        /**
+         * @brief Get the edge currently dispatched to the handlers
+         * @return PinEvent Level and micros() timestamp seen by the ISR, only meaningful
+         * inside an onInterrupt() callback
+         */
+        PinEvent getEvent() {
+            return current;
+        }
+
+        /**
+         * @brief Get the number of edges of one type dispatched so far
+         * @param edge RISING or FALLING
+         * @return uint32_t Edge count, wraps around
+         */
+        uint32_t getEdgeCount(int edge) {
+            return edge == RISING ? risingEdges : fallingEdges;
+        }
+
+        /**
+         * @brief Describe an edge to wait for with co_await, see Coroutine.h
+         * @param edge RISING or FALLING
+         * @param timeout Timeout in milliseconds, 0xFFFFFFFF for none
+         * @return PinEdge Awaitable edge, resumes with true on the edge, false on timeout
+         */
+        PinEdge edge(int edge, unsigned long timeout = 0xFFFFFFFF) {
+            return PinEdge { this, edge, timeout };
+        }
+
+        /**
+         * @brief Get the number of edges lost because the queue was full
+         * @return uint32_t Overflow count, see ASYNC_PIN_QUEUE_SIZE
+         */
+        uint32_t getOverflows() {
+            return overflows;
+        }
+
+        /**
+         * @brief Get the time at which the pin or one of its handlers has work to do
+         * @return uint64_t 0 if an interrupt is pending, NEVER otherwise
+         */
+        uint64_t wakeTime() override {
+            uint64_t next = events.empty() ? NEVER : 0;
+
+            for(int i=0; i < this->handlersRising.size(); i++) {
+                next = min(next, handlersRising.at(i)->wakeTime());
+            }
+            for(int i=0; i < this->handlersFalling.size(); i++) {
+                next = min(next, handlersFalling.at(i)->wakeTime());
+            }
+
+            return next;
+        }
+
         /**
          * @brief Tick handler for the pin and its tasks.
          * @return true if successful.
+         *
+         * @details Queued edges are dispatched oldest first, each one running the
+         * handlers of its own edge type once.
          */
         bool tick() {
-            interruptTask->tick();
+            PinEvent event;
+            bool dispatched = false;
+
+            while(events.pop(event)) {
+                dispatched = true;
+                current = event;
+                std::vector<async::Task*> & handlers = event.level == HIGH ? handlersRising : handlersFalling;
+
+                if(event.level == HIGH) {
+                    risingEdges++;
+                }
+                else {
+                    fallingEdges++;
+                }
+
+                for(int i=0; i < handlers.size(); i++) {
+                    handlers.at(i)->demand();
+                    handlers.at(i)->tick();
+                }
+            }
+
+            if(dispatched) {
+                for(size_t i=0; i < this->waiters.size(); i++) {
+                    this->waiters[i]->wake();
+                }
+            }
 
             for(int i=0; i < this->handlersRising.size(); i++) {
                 handlersRising.at(i)->tick();
@@ -0,0 +1,155 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <async/CriticalSection.h>
+#include <new>
+
+/**
+ * @file Pool.h
+ * @brief Defines the async::Pool fixed-capacity object allocator.
+ */
+
+namespace async {
+    /**
+     * @class Pool
+     * @brief Fixed-capacity allocator for objects of one type
+     *
+     * @details All slots live in one statically sized array, so a long-running device
+     * does not fragment its heap when objects are created and destroyed all the time.
+     * Allocation and release are O(1): released slots form a free list and untouched
+     * slots are handed out from a bump index, so construction does not walk the array.
+     *
+     * When the pool is exhausted, or a request is larger than one slot (e.g. a derived
+     * class), the allocation falls back to the heap and is counted in overflows().
+     * Choose the capacity from highWater() measured on a real workload.
+     *
+     * @tparam T Type of the pooled objects
+     * @tparam N Capacity in objects
+     *
+     * @note Allocation is guarded by a CriticalSection, so it is safe across cores,
+     * threads and task priorities, but must not be used from interrupts: the heap
+     * fallback may run.
+     */
+    template<typename T, size_t N>
+    class Pool {
+        private:
+            union Slot {
+                Slot * next;                                ///< Next free slot
+                alignas(T) unsigned char storage[sizeof(T)];///< Object storage
+            };
+
+            Slot slots[N];                 ///< Slot storage
+            Slot * freeList = nullptr;     ///< Released slots
+            size_t fresh = 0;              ///< Number of slots ever handed out
+            size_t inUse = 0;              ///< Slots currently allocated
+            size_t peak = 0;               ///< Highest value of inUse
+            size_t fallbacks = 0;          ///< Allocations served by the heap
+            CriticalSection critical;      ///< Guards the free list and the counters
+
+        public:
+            /**
+             * @brief Allocate storage for one object
+             * @param size Requested size in bytes
+             * @return void* Pointer to uninitialized storage
+             */
+            void * allocate(size_t size) {
+                Slot * slot = nullptr;
+
+                if(size <= sizeof(T)) {
+                    critical.lock();
+
+                    if(freeList != nullptr) {
+                        slot = freeList;
+                        freeList = slot->next;
+                    }
+                    else if(fresh < N) {
+                        slot = &slots[fresh++];
+                    }
+
+                    if(slot != nullptr && ++inUse > peak) {
+                        peak = inUse;
+                    }
+                    else if(slot == nullptr) {
+                        fallbacks++;
+                    }
+
+                    critical.unlock();
+                }
+                else {
+                    critical.lock();
+                    fallbacks++;
+                    critical.unlock();
+                }
+
+                return slot != nullptr ? (void *) slot->storage : ::operator new(size);
+            }
+
+            /**
+             * @brief Release storage obtained from allocate()
+             * @param ptr Pointer returned by allocate()
+             */
+            void deallocate(void * ptr) {
+                if(!owns(ptr)) {
+                    ::operator delete(ptr);
+                    return;
+                }
+
+                Slot * slot = (Slot *) ptr;
+
+                critical.lock();
+                slot->next = freeList;
+                freeList = slot;
+                inUse--;
+                critical.unlock();
+            }
+
+            /**
+             * @brief Check whether a pointer belongs to the pool storage
+             * @param ptr Pointer to check
+             * @return true if the pointer addresses a pool slot
+             */
+            bool owns(const void * ptr) const {
+                return (uintptr_t) ptr >= (uintptr_t) &slots[0] && (uintptr_t) ptr < (uintptr_t) &slots[N];
+            }
+
+            /**
+             * @brief Number of slots
+             * @return size_t Pool capacity
+             */
+            size_t capacity() const { return N; }
+
+            /**
+             * @brief Number of allocated slots
+             * @return size_t Slots currently in use
+             */
+            size_t used() const { return inUse; }
+
+            /**
+             * @brief Highest number of slots that were in use at the same time
+             * @return size_t High-water mark
+             */
+            size_t highWater() const { return peak; }
+
+            /**
+             * @brief Number of allocations that had to fall back to the heap
+             * @return size_t Overflow count
+             */
+            size_t overflows() const { return fallbacks; }
+    };
+}
+
+/**
+ * @brief Route class allocations of a type through a static Pool
+ * @param Type Class being declared
+ * @param Capacity Pool capacity in objects
+ *
+ * @details Declares a static pool() accessor for the statistics and class-specific
+ * operator new/delete. Use inside the class body.
+ */
+#define ASYNC_POOLED(Type, Capacity) \
+    static async::Pool<Type, Capacity> & pool() { \
+        static async::Pool<Type, Capacity> instance; \
+        return instance; \
+    } \
+    static void * operator new(size_t size) { return pool().allocate(size); } \
+    static void operator delete(void * ptr) { pool().deallocate(ptr); }
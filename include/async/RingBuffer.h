@@ -0,0 +1,96 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @file RingBuffer.h
+ * @brief Defines the async::RingBuffer single-producer/single-consumer queue.
+ */
+
+namespace async {
+    /**
+     * @class RingBuffer
+     * @brief Lock-free fixed-capacity queue for one producer and one consumer
+     *
+     * @details The producer only writes the head index and the consumer only writes the
+     * tail index, so push() and pop() need neither locks nor disabled interrupts. This
+     * makes the queue suitable for handing records from an ISR to the executor loop.
+     * A full queue rejects new elements instead of overwriting unread ones.
+     *
+     * @tparam T Element type, copied in and out
+     * @tparam N Capacity, must be a power of two
+     *
+     * @note Exactly one context may call push() and exactly one may call pop().
+     */
+    template<typename T, size_t N>
+    class RingBuffer {
+        static_assert(N > 0 && (N & (N - 1)) == 0, "RingBuffer capacity must be a power of two");
+
+        private:
+            T items[N];                   ///< Element storage
+            std::atomic<uint32_t> head;   ///< Next slot to write, owned by the producer
+            std::atomic<uint32_t> tail;   ///< Next slot to read, owned by the consumer
+
+        public:
+            RingBuffer() : head(0), tail(0) {}
+
+            /**
+             * @brief Append an element (producer side)
+             * @param item Element to copy into the queue
+             * @return true if stored, false if the queue is full
+             */
+            bool push(const T & item) {
+                uint32_t write = head.load(std::memory_order_relaxed);
+
+                if(write - tail.load(std::memory_order_acquire) >= N) {
+                    return false;
+                }
+
+                items[write & (N - 1)] = item;
+                head.store(write + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * @brief Remove the oldest element (consumer side)
+             * @param[out] item Receives the element
+             * @return true if an element was removed, false if the queue is empty
+             */
+            bool pop(T & item) {
+                uint32_t read = tail.load(std::memory_order_relaxed);
+
+                if(read == head.load(std::memory_order_acquire)) {
+                    return false;
+                }
+
+                item = items[read & (N - 1)];
+                tail.store(read + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * @brief Number of stored elements
+             * @return size_t Queue size, a snapshot when called concurrently
+             */
+            size_t size() const {
+                return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+            }
+
+            /**
+             * @brief Check whether the queue is empty
+             * @return true if nothing is stored
+             */
+            bool empty() const {
+                return size() == 0;
+            }
+
+            /**
+             * @brief Number of elements the queue can hold
+             * @return size_t Queue capacity
+             */
+            size_t capacity() const {
+                return N;
+            }
+    };
+}
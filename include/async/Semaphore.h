@@ -1,4 +1,7 @@
 #pragma once
+#include <async/Tick.h>
+#include <async/CriticalSection.h>
+#include <atomic>
 
 /**
  * @file Semaphore.h
@@ -8,17 +11,116 @@
 namespace async {
 
     /**
-     * @brief A simple counting semaphore for asynchronous resource management.
+     * @brief A counting semaphore for asynchronous resource management.
      *
-     * The Semaphore class provides a mechanism to control access to a shared resource
-     * by multiple tasks in an asynchronous environment. It supports acquiring and releasing
-     * the semaphore, as well as querying the available count and lock status.
+     * The count is an atomic, so tryAcquire(), release() and available() may be called
+     * from interrupts and from both cores.
+     *
+     * Tick objects that pass themselves to tryAcquire(Tick*) are queued in FIFO order
+     * when no permit is free. The first waiter is woken with Tick::wake() on release()
+     * and is the only one that can take the next permit, so nobody is polled and nobody
+     * starves. Plain tryAcquire() calls do not overtake queued waiters either.
+     *
+     * The waiter queue is guarded by a CriticalSection. release() pins the first waiter
+     * while it wakes it, and forget() waits for such a wake-up to finish, so a waiter
+     * may be deleted right after it was forgotten or left its executor.
+     *
+     * @note Call tryAcquire(Tick*) and forget() from task context only.
      */
     class Semaphore {
         private:
-            int count;                ///< Current available count.
-            const int maxCount;       ///< Maximum count allowed.
-            volatile bool lock = false; ///< Indicates if the semaphore is currently locked.
+            std::atomic<int> count;       ///< Current available count.
+            const int maxCount;           ///< Maximum count allowed.
+            std::atomic<Tick *> head;     ///< First waiter, read by tryAcquire() without the lock.
+            Tick * tail = nullptr;        ///< Last waiter.
+            CriticalSection critical;     ///< Guards the waiter queue.
+
+            /**
+             * @brief Take a permit if one is free.
+             */
+            bool take() {
+                int current = count.load(std::memory_order_relaxed);
+
+                while (current > 0) {
+                    if (count.compare_exchange_weak(current, current - 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+            /**
+             * @brief Append a waiter unless it is queued already, with the lock held.
+             */
+            void enqueue(Tick * tick) {
+                if (tick->wakeLink.waitNext != nullptr || tail == tick) {
+                    return;
+                }
+
+                if (tail != nullptr) {
+                    tail->wakeLink.waitNext = tick;
+                }
+                else {
+                    head.store(tick, std::memory_order_release);
+                }
+
+                tail = tick;
+            }
+
+            /**
+             * @brief Unlink a waiter, with the lock held.
+             */
+            void dequeue(Tick * tick) {
+                Tick * previous = nullptr;
+                Tick * item = head.load(std::memory_order_relaxed);
+
+                while (item != nullptr && item != tick) {
+                    previous = item;
+                    item = item->wakeLink.waitNext;
+                }
+
+                if (item == nullptr) {
+                    return;
+                }
+
+                if (previous != nullptr) {
+                    previous->wakeLink.waitNext = tick->wakeLink.waitNext;
+                }
+                else {
+                    head.store(tick->wakeLink.waitNext, std::memory_order_release);
+                }
+
+                if (tail == tick) {
+                    tail = previous;
+                }
+
+                tick->wakeLink.waitNext = nullptr;
+            }
+
+            /**
+             * @brief Wake the first waiter if a permit is free.
+             */
+            void notify() {
+                if (count.load(std::memory_order_acquire) <= 0) {
+                    return;
+                }
+
+                // Pin the waiter under the lock, forget() waits for the pin to go
+                critical.lock();
+                Tick * first = head.load(std::memory_order_relaxed);
+
+                if (first != nullptr) {
+                    first->wakeLink.pushing.fetch_add(1, std::memory_order_seq_cst);
+                }
+
+                critical.unlock();
+
+                if (first != nullptr) {
+                    first->wake();
+                    first->wakeLink.pushing.fetch_sub(1, std::memory_order_release);
+                }
+            }
 
         public:
             /**
@@ -27,45 +129,137 @@ namespace async {
              * @param maximumCount Maximum count value.
              */
             Semaphore(int initialCount, int maximumCount)
-                : count(initialCount), maxCount(maximumCount) {}
+                : count(initialCount), maxCount(maximumCount), head(nullptr) {}
 
             /**
              * @brief Try to acquire the semaphore.
-             * @return true if acquired successfully, false otherwise.
+             * @return true if acquired successfully, false if no permit is free or
+             * Tick objects are queued for one.
              */
             bool tryAcquire() {
-                if (count > 0 && !lock) {
-                    --count;
-                    lock = true;
+                if (head.load(std::memory_order_acquire) != nullptr) {
+                    return false;
+                }
+
+                return take();
+            }
+
+            /**
+             * @brief Try to acquire the semaphore, queueing the caller on failure.
+             * @param waiter Tick to wake once it is first in line and a permit is free.
+             * @return true if acquired successfully, the waiter then leaves the queue.
+             */
+            bool tryAcquire(Tick * waiter) {
+                Tick * first = head.load(std::memory_order_acquire);
+
+                if ((first == nullptr || first == waiter) && take()) {
+                    if (first == waiter) {
+                        critical.lock();
+                        dequeue(waiter);
+                        critical.unlock();
+                        WakeQueue::settle(waiter);
+
+                        // More permits may be free for the next waiter
+                        notify();
+                    }
+
                     return true;
                 }
+
+                critical.lock();
+                enqueue(waiter);
+                critical.unlock();
+
+                // A release before the waiter was queued had nobody to wake
+                notify();
                 return false;
             }
 
             /**
-             * @brief Check if the semaphore is currently locked.
+             * @brief Check whether tryAcquire(Tick*) would succeed for a waiter.
+             * @param waiter Tick that is queued, or about to be.
+             */
+            bool ready(Tick * waiter) {
+                Tick * first = head.load(std::memory_order_acquire);
+                return count.load(std::memory_order_acquire) > 0 && (first == nullptr || first == waiter);
+            }
+
+            /**
+             * @brief Remove a waiter from the queue, e.g. because it is cancelled.
+             * @param waiter Tick passed to tryAcquire(Tick*), may be not queued.
+             *
+             * Returns once no release() is waking the waiter any more.
+             */
+            void forget(Tick * waiter) {
+                critical.lock();
+                dequeue(waiter);
+                critical.unlock();
+
+                // A release() may still be waking the waiter
+                WakeQueue::settle(waiter);
+                notify();
+            }
+
+            /**
+             * @brief Check if no permit is left.
              * @return true if locked, false otherwise.
              */
             bool isLock() const {
-                return lock;
+                return count.load(std::memory_order_acquire) <= 0;
             }
 
             /**
              * @brief Release the semaphore.
              *
-             * Unlocks the semaphore and increments the count if below maxCount.
+             * Increments the count if below maxCount and wakes the first waiter.
              */
             void release() {
-                lock = false;
-                if (count < maxCount) {
-                    ++count;
+                int current = count.load(std::memory_order_relaxed);
+
+                while (current < maxCount) {
+                    if (count.compare_exchange_weak(current, current + 1, std::memory_order_release, std::memory_order_relaxed)) {
+                        break;
+                    }
                 }
+
+                notify();
             }
 
             /**
              * @brief Get the number of available resources.
              * @return Current available count.
              */
-            int available() const { return count; }
+            int available() const { return count.load(std::memory_order_acquire); }
+    };
+
+    /**
+     * @brief A mutex, a Semaphore with a single permit.
+     */
+    class Mutex : public Semaphore {
+        public:
+            Mutex() : Semaphore(1, 1) {}
+
+            /**
+             * @brief Try to lock the mutex.
+             * @return true if locked by the caller.
+             */
+            bool tryLock() { return tryAcquire(); }
+
+            /**
+             * @brief Try to lock the mutex, queueing the caller on failure.
+             * @param waiter Tick to wake once it is first in line and the mutex is free.
+             * @return true if locked by the caller.
+             */
+            bool tryLock(Tick * waiter) { return tryAcquire(waiter); }
+
+            /**
+             * @brief Unlock the mutex and wake the first waiter.
+             */
+            void unlock() { release(); }
+
+            /**
+             * @brief Check if the mutex is locked.
+             */
+            bool isLocked() const { return isLock(); }
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,288 @@
+#pragma once
+#include <Arduino.h>
+#include <async/Tick.h>
+#include <async/Clock.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/**
+ * @file Simulator.h
+ * @brief Defines async::Simulator, a virtual-time harness for host builds.
+ */
+
+#if !defined(ARDUINO)
+namespace async {
+    /**
+     * @class Simulator
+     * @brief Runs a scheduler against a virtual clock, jumping from deadline to deadline
+     *
+     * @details The simulator switches the host shim to its virtual clock and then drives
+     * a scheduler, normally an Executor, by calling tick() and wakeTime() alternately.
+     * When nothing is runnable it moves the clock straight to the earliest of the next
+     * wakeTime() and the next scripted pin edge, so a simulated week of REPEAT tasks
+     * and Chain delays runs in milliseconds. Objects that are always runnable, such as
+     * TICK tasks or polled Chain steps, make the clock advance in steps of the quantum
+     * instead.
+     *
+     * Scripted edges are applied with host::setPin(), which runs the attached interrupt
+     * handlers exactly like the hardware would, right before the pass at their time.
+     * Callbacks call mark() to record what happened when; expect() and expectOrder()
+     * compare the record against the intended schedule.
+     *
+     * All times are in microseconds since the simulator was created.
+     *
+     * @note Do not call Executor::sleep() while the simulator runs, it would wait for
+     * real time.
+     */
+    class Simulator {
+        static_assert(ASYNC_CLOCK == ASYNC_CLOCK_ARDUINO || ASYNC_CLOCK == ASYNC_CLOCK_VIRTUAL,
+            "Simulator needs the micros() or the virtual clock backend");
+
+        public:
+            /**
+             * @brief A mark() recorded by a callback
+             */
+            struct Mark {
+                uint64_t time;      ///< Simulated time of the mark
+                std::string label;  ///< Label given to mark()
+            };
+
+        private:
+            /**
+             * @brief A scripted pin level change
+             */
+            struct Edge {
+                uint64_t time;  ///< Simulated time of the edge
+                uint8_t pin;    ///< Pin number
+                int level;      ///< New level
+            };
+
+            // The micros() backend detects wraps of the 32-bit counter on the next read,
+            // so the clock never jumps further than half its period at once
+            static const uint64_t MAX_JUMP = 1800000000ULL;
+            static int const MAX_SAME_TIME = 16;
+
+            Tick & scheduler;
+            uint64_t origin;
+            uint64_t quantum = 1000;
+            std::vector<Edge> edges;    ///< Pending edges, ordered by time
+            std::vector<Mark> record;   ///< Marks in call order
+            uint32_t passes = 0;
+
+            /**
+             * @brief Move the clock forward to an absolute uptimeMicros() time
+             */
+            void moveTo(uint64_t target) {
+                uint64_t now = Clock::micros();
+
+                while(now < target) {
+                    uint64_t step = target - now;
+                    now += step < MAX_JUMP ? step : MAX_JUMP;
+                    Clock::set(now);
+                    Clock::micros();
+                }
+            }
+
+            /**
+             * @brief Apply every scripted edge that is due
+             */
+            void applyEdges() {
+                uint64_t now = this->now();
+
+                while(!edges.empty() && edges.front().time <= now) {
+                    Edge edge = edges.front();
+                    edges.erase(edges.begin());
+                    host::setPin(edge.pin, edge.level);
+                }
+            }
+
+        public:
+            /**
+             * @brief Create a simulator for a scheduler
+             * @param scheduler Executor or any other Tick to drive
+             *
+             * @details Switches the shim to its virtual clock; the time is kept, so objects
+             * that were already started see no jump.
+             */
+            Simulator(Tick & scheduler) : scheduler(scheduler) {
+                host::useVirtualClock(true);
+                this->origin = Clock::micros();
+            }
+
+            /**
+             * @brief Get the simulated time
+             * @return uint64_t Microseconds since the simulator was created
+             */
+            uint64_t now() {
+                return Clock::micros() - this->origin;
+            }
+
+            /**
+             * @brief Set the step used while something is runnable all the time
+             * @param us Clock advance in microseconds, default 1000
+             */
+            void setQuantum(uint64_t us) {
+                this->quantum = us > 0 ? us : 1;
+            }
+
+            /**
+             * @brief Schedule a pin level change
+             * @param time Simulated time in microseconds
+             * @param pin Pin number
+             * @param level HIGH or LOW
+             */
+            void edge(uint64_t time, uint8_t pin, int level) {
+                Edge edge = { time, pin, level };
+                auto at = std::upper_bound(edges.begin(), edges.end(), edge, [](const Edge & a, const Edge & b) {
+                    return a.time < b.time;
+                });
+                edges.insert(at, edge);
+            }
+
+            /**
+             * @brief Schedule a pulse, two edges
+             * @param time Simulated time of the first edge in microseconds
+             * @param pin Pin number
+             * @param width Pulse width in microseconds
+             * @param level Level during the pulse, HIGH by default
+             */
+            void pulse(uint64_t time, uint8_t pin, uint64_t width, int level = HIGH) {
+                edge(time, pin, level);
+                edge(time + width, pin, level == HIGH ? LOW : HIGH);
+            }
+
+            /**
+             * @brief Run until a simulated time
+             * @param time Simulated time in microseconds
+             * @return uint32_t Number of scheduler passes
+             *
+             * @note Work that becomes due exactly at the end time is still run
+             */
+            uint32_t runUntil(uint64_t time) {
+                uint32_t count = 0;
+                int same = 0;
+
+                while(true) {
+                    applyEdges();
+                    this->scheduler.tick();
+                    count++;
+
+                    uint64_t now = this->now();
+                    uint64_t wake = this->scheduler.wakeTime();
+                    uint64_t next = wake == Tick::NEVER ? Tick::NEVER : wake > this->origin ? wake - this->origin : 0;
+
+                    if(!edges.empty() && edges.front().time < next) {
+                        next = edges.front().time;
+                    }
+
+                    if(next <= now) {
+                        // Give work that just became runnable a few passes at the same time
+                        if(++same < MAX_SAME_TIME) {
+                            continue;
+                        }
+
+                        next = now + this->quantum;
+                    }
+
+                    if(now >= time) {
+                        break;
+                    }
+
+                    same = 0;
+                    moveTo(this->origin + (next < time ? next : time));
+                }
+
+                this->passes += count;
+                return count;
+            }
+
+            /**
+             * @brief Run for a simulated duration
+             * @param us Duration in microseconds
+             * @return uint32_t Number of scheduler passes
+             */
+            uint32_t runFor(uint64_t us) {
+                return runUntil(now() + us);
+            }
+
+            /**
+             * @brief Total number of scheduler passes
+             * @return uint32_t Pass count
+             */
+            uint32_t getPasses() {
+                return this->passes;
+            }
+
+            /**
+             * @brief Record an event at the current simulated time
+             * @param label Name of the event
+             */
+            void mark(std::string label) {
+                record.push_back({ now(), std::move(label) });
+            }
+
+            /**
+             * @brief Get the recorded marks
+             * @return std::vector<Mark> const& Marks in call order
+             */
+            std::vector<Mark> const & marks() const {
+                return record;
+            }
+
+            /**
+             * @brief Forget the recorded marks
+             */
+            void clearMarks() {
+                record.clear();
+            }
+
+            /**
+             * @brief Compare the marks with an expected schedule
+             * @param expected Marks expected, in order
+             * @param tolerance Allowed difference of each time in microseconds
+             * @return true if labels, count and times match; the first difference is
+             * printed to stderr otherwise
+             */
+            bool expect(std::vector<Mark> const & expected, uint64_t tolerance = 0) const {
+                size_t count = std::max(expected.size(), record.size());
+
+                for(size_t i=0; i < count; i++) {
+                    if(i >= record.size() || i >= expected.size()) {
+                        fprintf(stderr, "mark %zu: expected %s, got %s\n", i,
+                            i < expected.size() ? expected[i].label.c_str() : "nothing",
+                            i < record.size() ? record[i].label.c_str() : "nothing");
+                        return false;
+                    }
+
+                    uint64_t low = expected[i].time > tolerance ? expected[i].time - tolerance : 0;
+
+                    if(record[i].label != expected[i].label || record[i].time < low || record[i].time > expected[i].time + tolerance) {
+                        fprintf(stderr, "mark %zu: expected %s at %llu us, got %s at %llu us\n", i,
+                            expected[i].label.c_str(), (unsigned long long) expected[i].time,
+                            record[i].label.c_str(), (unsigned long long) record[i].time);
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            /**
+             * @brief Compare the order of the marks, ignoring their times
+             * @param labels Labels expected, in order
+             * @return true if the labels match; the first difference is printed to
+             * stderr otherwise
+             */
+            bool expectOrder(std::vector<std::string> const & labels) const {
+                std::vector<Mark> expected;
+
+                for(size_t i=0; i < labels.size(); i++) {
+                    expected.push_back({ i < record.size() ? record[i].time : 0, labels[i] });
+                }
+
+                return expect(expected);
+            }
+    };
+}
+#endif
@@ -0,0 +1,125 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+#if defined(ARDUINO_ARCH_ESP32)
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/semphr.h>
+#elif !defined(ARDUINO)
+    #include <condition_variable>
+    #include <mutex>
+#endif
+
+/**
+ * @file Sleep.h
+ * @brief Defines the async::Sleep helper used by executors to idle between deadlines.
+ */
+
+namespace async {
+    /**
+     * @class Sleep
+     * @brief Blocks one loop until a timeout expires or a wake() arrives
+     *
+     * @details Sleep behaves like a binary semaphore: wake() may be called from an
+     * interrupt, another core or another thread, and makes the current or the next
+     * wait() return immediately. This closes the race between computing the next
+     * deadline and going to sleep.
+     *
+     * Every Executor owns one, and Tick::wake() signals the one of the executor that
+     * manages the object, so loops on different cores or threads never consume each
+     * other's wakeups.
+     *
+     * Backends:
+     * - ESP32: FreeRTOS binary semaphore, optionally esp_light_sleep_start() for long
+     *   waits, ended early by the timer or an edge on a pin added with addWakePin()
+     * - Other Arduino cores: yield() loop until timeout or wake
+     * - Host builds: std::condition_variable
+     *
+     * A custom waiter can replace the backend, e.g. to advance a stub clock on a host.
+     */
+    class Sleep {
+        public:
+            /**
+             * @brief Custom wait function
+             * @param ms Requested sleep time in milliseconds, FOREVER for no timeout
+             */
+            typedef void (*Waiter)(uint64_t ms);
+
+            /**
+             * @brief Interrupt handler of a wake pin
+             * @param arg Argument given to addWakePin()
+             */
+            typedef void (*PinHandler)(void * arg);
+
+            static const uint64_t FOREVER = (uint64_t)-1; ///< Wait without timeout
+
+        private:
+            std::atomic<bool> pending;  ///< A wake() arrived since the last wait() returned
+#if defined(ARDUINO_ARCH_ESP32)
+            SemaphoreHandle_t semaphore = nullptr; ///< Created by the first wait(), outside of any ISR
+#elif !defined(ARDUINO)
+            std::mutex mutex;
+            std::condition_variable condition;
+#endif
+
+        public:
+            Sleep() : pending(false) {}
+            ~Sleep();
+
+            Sleep(const Sleep &) = delete;
+            Sleep & operator=(const Sleep &) = delete;
+
+            /**
+             * @brief Block until the timeout expires or wake() is called
+             * @param ms Timeout in milliseconds, FOREVER for no timeout
+             * @return true if woken by wake(), false on timeout
+             *
+             * @note Only the loop owning the object may wait
+             */
+            bool wait(uint64_t ms);
+
+            /**
+             * @brief Wake a pending or the next wait()
+             *
+             * @note Safe to call from interrupts and from other cores or threads
+             */
+            void wake();
+
+            /**
+             * @brief Replace the platform wait backend of every loop
+             * @param waiter Custom wait function, nullptr restores the default backend
+             *
+             * @note A pending wake() is consumed before the waiter is called
+             */
+            static void setWaiter(Waiter waiter);
+
+            /**
+             * @brief Use light sleep for waits of at least the given length (ESP32 only)
+             * @param ms Minimum wait in milliseconds to enter light sleep, 0 disables it
+             *
+             * @details Light sleep ends at the requested time or on a level change of a
+             * pin added with addWakePin(); Pin objects with an interrupt add themselves.
+             * Other interrupt sources are only seen after the timer wakeup.
+             */
+            static void setLightSleep(uint64_t ms);
+
+            /**
+             * @brief Let a level change on a pin end light sleep (ESP32 only)
+             * @param pin GPIO number with an edge interrupt attached
+             * @param handler Interrupt handler, run for an edge that ended light sleep
+             * @param arg Argument passed to the handler
+             *
+             * @details During light sleep the pin's interrupt is masked and the GPIO
+             * wakes the chip on the level opposite to the one it had when the loop went
+             * to sleep; the handler then runs once for that edge. At most
+             * ASYNC_SLEEP_WAKE_PINS pins are watched, adding a pin again replaces it.
+             */
+            static void addWakePin(uint8_t pin, PinHandler handler, void * arg);
+
+            /**
+             * @brief Stop a pin from ending light sleep
+             * @param pin GPIO number given to addWakePin()
+             */
+            static void removeWakePin(uint8_t pin);
+    };
+}
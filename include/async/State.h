@@ -1,8 +1,9 @@
 #pragma once
 #include <async/Log.h>
 #include <async/Task.h>
+#include <async/InplaceFunction.h>
+#include <async/Trace.h>
 #include <vector>
-#include <functional>
 
 /**
  * @file State.h
@@ -36,12 +37,12 @@ namespace async {
             /**
              * @brief Callback type for change events (new value, previous value).
              */
-            typedef std::function<void(T, T)> OnChangeAllArgsCallback;
+            typedef InplaceFunction<void(T, T)> OnChangeAllArgsCallback;
 
             /**
              * @brief Callback type for custom get/set logic.
              */
-            typedef std::function<T(T)> GetAndSetAllArgsCallback;
+            typedef InplaceFunction<T(T)> GetAndSetAllArgsCallback;
 
         private:
             std::vector<OnChangeAllArgsCallback> callbacks; ///< List of change callbacks.
@@ -53,9 +54,13 @@ namespace async {
              */
             State(T value) : currValue(value) {
                 task = new Task(Task::DEMAND, [&] () {
+                    ASYNC_TRACE_EVENT(Trace::BEGIN, Trace::STATE_SET, this, 0);
+
                     for(int i=0; i < callbacks.size(); i++) {
                         callbacks[i](currValue, prevValue);
                     }
+
+                    ASYNC_TRACE_EVENT(Trace::END, Trace::STATE_SET, this, 0);
                 });
             }
 
@@ -64,7 +69,7 @@ namespace async {
              * @param cbCallback Callback function.
              */
             void onChange(OnChangeAllArgsCallback cbCallback) { 
-                callbacks.push_back(cbCallback);
+                callbacks.push_back(std::move(cbCallback));
             }
 
             /**
@@ -96,6 +101,14 @@ namespace async {
                 }
             }
 
+            /**
+             * @brief Get the time at which change callbacks are pending
+             * @return uint64_t 0 after a change, NEVER otherwise
+             */
+            uint64_t wakeTime() override {
+                return task->wakeTime();
+            }
+
             /**
              * @brief Tick handler for the state.
              * @return true if successful.
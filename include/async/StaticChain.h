@@ -0,0 +1,491 @@
+#pragma once
+#include <Arduino.h>
+#include <async/Tick.h>
+#include <async/Duration.h>
+#include <async/Pin.h>
+#include <async/Semaphore.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @file StaticChain.h
+ * @brief Defines async::StaticChain, a Chain whose steps are fixed at compile time.
+ */
+
+namespace async {
+    /**
+     * @brief Results of a step poll
+     */
+    namespace step {
+        static int const WAIT = 0;  ///< Step not finished, poll again later
+        static int const NEXT = 1;  ///< Step finished, go on with the next one
+        static int const STOP = 2;  ///< End this run of the chain
+
+        /**
+         * @brief Wait for a fixed time
+         */
+        class Delay {
+            private:
+                uint64_t duration;  ///< Length in microseconds
+                uint64_t until = 0; ///< uptimeMicros() time the step ends at
+
+            public:
+                explicit Delay(uint64_t us) : duration(us) {}
+
+                void enter(uint64_t now) {
+                    this->until = now + this->duration;
+                }
+
+                int poll(uint64_t now) {
+                    return now >= this->until ? NEXT : WAIT;
+                }
+
+                uint64_t deadline() {
+                    return this->until;
+                }
+
+                uint64_t wakeTime() {
+                    return this->until;
+                }
+        };
+
+        /**
+         * @brief Run a callback
+         * @tparam F Callable without arguments
+         */
+        template<typename F>
+        class Then {
+            private:
+                F callback;
+
+            public:
+                explicit Then(F callback) : callback(std::move(callback)) {}
+
+                void enter(uint64_t) {}
+
+                int poll(uint64_t) {
+                    this->callback();
+                    return NEXT;
+                }
+
+                uint64_t deadline() {
+                    return 0;
+                }
+
+                uint64_t wakeTime() {
+                    return 0;
+                }
+        };
+
+        /**
+         * @brief Acquire a semaphore, waiting or ending the run when it is taken
+         *
+         * @details A waiting step queues its chain on the semaphore in FIFO order with
+         * Chain and coroutine waiters, and the chain stays parked until release() wakes it.
+         */
+        class Acquire {
+            private:
+                Semaphore * semaphore;
+                bool wait;              ///< Wait for the semaphore instead of ending the run
+                Tick * chain = nullptr; ///< Chain running the step, queued while waiting
+                bool queued = false;    ///< The chain is in the waiter queue
+
+            public:
+                Acquire(Semaphore * semaphore, bool wait) : semaphore(semaphore), wait(wait) {}
+
+                /**
+                 * @brief Set the chain to queue on the semaphore
+                 */
+                void attach(Tick * chain) {
+                    this->chain = chain;
+                }
+
+                /**
+                 * @brief Leave the waiter queue, e.g. because the chain is cancelled
+                 */
+                void leave() {
+                    if(this->queued) {
+                        this->semaphore->forget(this->chain);
+                        this->queued = false;
+                    }
+                }
+
+                void enter(uint64_t) {}
+
+                int poll(uint64_t) {
+                    if(!this->wait) {
+                        return this->semaphore->tryAcquire() ? NEXT : STOP;
+                    }
+
+                    if(this->semaphore->tryAcquire(this->chain)) {
+                        this->queued = false;
+                        return NEXT;
+                    }
+
+                    this->queued = true;
+                    return WAIT;
+                }
+
+                uint64_t deadline() {
+                    return this->queued && !this->semaphore->ready(this->chain) ? Tick::NEVER : 0;
+                }
+
+                uint64_t wakeTime() {
+                    return deadline();
+                }
+        };
+
+        /**
+         * @brief Wait for a pin edge or a timeout
+         *
+         * @details The chain is added as a waiter of the pin while the step waits, so
+         * an edge wakes it and the executor only keeps it for the timeout.
+         */
+        class Edge {
+            private:
+                Pin * pin;
+                int edge;
+                uint64_t timeout;       ///< Timeout in microseconds, NEVER for none
+                uint32_t count = 0;     ///< Edge count when the step was entered
+                uint64_t until = 0;     ///< Timeout time
+                Tick * chain = nullptr; ///< Chain running the step, woken by an edge
+
+            public:
+                Edge(Pin * pin, int edge, uint64_t timeout) : pin(pin), edge(edge), timeout(timeout) {}
+
+                /**
+                 * @brief Set the chain to wake on an edge
+                 */
+                void attach(Tick * chain) {
+                    this->chain = chain;
+                }
+
+                /**
+                 * @brief Stop waking the chain, e.g. because it is cancelled
+                 */
+                void leave() {
+                    this->pin->removeWaiter(this->chain);
+                }
+
+                void enter(uint64_t now) {
+                    this->count = this->pin->getEdgeCount(this->edge);
+                    this->until = this->timeout == Tick::NEVER ? Tick::NEVER : now + this->timeout;
+                    this->pin->addWaiter(this->chain);
+                }
+
+                int poll(uint64_t now) {
+                    if(this->pin->getEdgeCount(this->edge) == this->count && now < this->until) {
+                        return WAIT;
+                    }
+
+                    leave();
+                    return NEXT;
+                }
+
+                uint64_t deadline() {
+                    return wakeTime();
+                }
+
+                uint64_t wakeTime() {
+                    return this->pin->getEdgeCount(this->edge) != this->count ? 0 : this->until;
+                }
+        };
+
+        /**
+         * @brief Tell a step which chain runs it, nothing to do for most steps
+         */
+        template<typename S>
+        void attach(S &, Tick *) {}
+
+        inline void attach(Acquire & step, Tick * chain) {
+            step.attach(chain);
+        }
+
+        inline void attach(Edge & step, Tick * chain) {
+            step.attach(chain);
+        }
+
+        /**
+         * @brief Let a step that was entered release what it waits for
+         */
+        template<typename S>
+        void leave(S &) {}
+
+        inline void leave(Acquire & step) {
+            step.leave();
+        }
+
+        inline void leave(Edge & step) {
+            step.leave();
+        }
+
+        ///@name Step Factory Methods
+        ///@{
+
+        /**
+         * @brief Wait before the next step
+         * @param ms Delay in milliseconds
+         */
+        inline Delay delay(unsigned long ms) {
+            return Delay((uint64_t) ms * 1000);
+        }
+
+        /**
+         * @brief Wait before the next step, with microsecond resolution
+         * @param duration Step length
+         */
+        inline Delay delay(Duration duration) {
+            return Delay(duration.get(Duration::MICRO));
+        }
+
+        /**
+         * @brief Run a callback
+         * @param callback Callable without arguments, stored by value
+         */
+        template<typename F>
+        Then<typename std::decay<F>::type> then(F && callback) {
+            return Then<typename std::decay<F>::type>(std::forward<F>(callback));
+        }
+
+        /**
+         * @brief Wait until a semaphore is acquired
+         * @param semaphore Semaphore to acquire
+         */
+        inline Acquire acquire(Semaphore * semaphore) {
+            return Acquire(semaphore, true);
+        }
+
+        /**
+         * @brief Acquire a semaphore, or end the run if it is taken
+         * @param semaphore Semaphore to acquire
+         */
+        inline Acquire tryAcquire(Semaphore * semaphore) {
+            return Acquire(semaphore, false);
+        }
+
+        /**
+         * @brief Wait for a pin edge
+         * @param pin Pin, must be added to the same executor
+         * @param edge RISING or FALLING
+         * @param timeout Timeout in milliseconds, 0xFFFFFFFF for none
+         */
+        inline Edge edge(Pin * pin, int edge, unsigned long timeout = 0xFFFFFFFF) {
+            return Edge(pin, edge, timeout == 0xFFFFFFFF ? Tick::NEVER : (uint64_t) timeout * 1000);
+        }
+
+        ///@}
+    }
+
+    /**
+     * @class StaticChain
+     * @brief Sequence of steps whose types and storage are fixed at compile time
+     *
+     * @details The counterpart of Chain<void> for sequences that never change: each step
+     * is its own type, stored by value in a tuple, and the current step is dispatched by
+     * template recursion over the step index, so there are no Operation allocations,
+     * no per-step fields for other step kinds and no indirect calls. A chain can live in
+     * static storage or on the stack: it is not owned (see Tick::setOwned()), so an
+     * executor cancels it on remove() but never deletes it. Call setOwned(true) for a
+     * chain created with new that the executor should delete.
+     *
+     * Consecutive steps that are ready run within one tick; the chain stops at the first
+     * step that has to wait. wakeTime() reports that step's time, so the executor can
+     * sleep through delays.
+     *
+     * @code
+     * auto blink = makeChain(
+     *     step::then([]() { digitalWrite(LED_BUILTIN, HIGH); }),
+     *     step::delay(100),
+     *     step::then([]() { digitalWrite(LED_BUILTIN, LOW); }),
+     *     step::delay(900)).loop();
+     * executor.add(&blink);
+     * @endcode
+     *
+     * @note tick() never returns false, a finished or cancelled chain stays parked until
+     * restart(). A chain on the stack must be removed before it goes out of scope.
+     *
+     * @tparam Steps Step types, see namespace step
+     */
+    template<typename... Steps>
+    class StaticChain : public Tick {
+        private:
+            typedef std::tuple<Steps...> StepTuple;
+            static size_t const COUNT = sizeof...(Steps);
+            static_assert(sizeof...(Steps) < 255, "StaticChain holds at most 254 steps, the step index is a uint8_t");
+
+            /**
+             * @brief Calls into the step at a runtime index
+             * @tparam I Index of the step this level handles
+             */
+            template<size_t I, bool End = (I >= sizeof...(Steps))>
+            struct Dispatch {
+                static void enter(StepTuple & steps, size_t index, uint64_t now, Tick * chain) {
+                    if(index == I) {
+                        step::attach(std::get<I>(steps), chain);
+                        std::get<I>(steps).enter(now);
+                    }
+                    else {
+                        Dispatch<I + 1>::enter(steps, index, now, chain);
+                    }
+                }
+
+                static void leave(StepTuple & steps, size_t index) {
+                    if(index == I) {
+                        step::leave(std::get<I>(steps));
+                    }
+                    else {
+                        Dispatch<I + 1>::leave(steps, index);
+                    }
+                }
+
+                static int poll(StepTuple & steps, size_t index, uint64_t now) {
+                    return index == I ? std::get<I>(steps).poll(now) : Dispatch<I + 1>::poll(steps, index, now);
+                }
+
+                static uint64_t deadline(StepTuple & steps, size_t index) {
+                    return index == I ? std::get<I>(steps).deadline() : Dispatch<I + 1>::deadline(steps, index);
+                }
+
+                static uint64_t wakeTime(StepTuple & steps, size_t index) {
+                    return index == I ? std::get<I>(steps).wakeTime() : Dispatch<I + 1>::wakeTime(steps, index);
+                }
+            };
+
+            template<size_t I>
+            struct Dispatch<I, true> {
+                static void enter(StepTuple &, size_t, uint64_t, Tick *) {}
+                static void leave(StepTuple &, size_t) {}
+                static int poll(StepTuple &, size_t, uint64_t) { return step::STOP; }
+                static uint64_t deadline(StepTuple &, size_t) { return 0; }
+                static uint64_t wakeTime(StepTuple &, size_t) { return NEVER; }
+            };
+
+            StepTuple steps;
+            uint8_t index = 0;      ///< Current step, COUNT when finished
+            bool entered = false;   ///< enter() was called for the current step
+            bool looping = false;
+            bool cancelled = false;
+
+        public:
+            explicit StaticChain(Steps... steps) : steps(std::move(steps)...) {
+                this->setOwned(false);
+            }
+
+            /**
+             * @brief Start over after the last step instead of finishing
+             * @return StaticChain& This chain
+             */
+            StaticChain & loop() {
+                this->looping = true;
+                return *this;
+            }
+
+            /**
+             * @brief Run the chain again from the first step
+             */
+            void restart() {
+                if(this->entered) {
+                    Dispatch<0>::leave(this->steps, this->index);
+                }
+
+                this->index = 0;
+                this->entered = false;
+                this->cancelled = false;
+                this->wake();
+            }
+
+            /**
+             * @brief Check whether the chain has finished or was cancelled
+             */
+            bool finished() {
+                return this->cancelled || this->index >= COUNT;
+            }
+
+            bool start() override {
+                restart();
+                return true;
+            }
+
+            bool cancel() override {
+                if(this->entered) {
+                    Dispatch<0>::leave(this->steps, this->index);
+                    this->entered = false;
+                }
+
+                this->cancelled = true;
+                return true;
+            }
+
+            bool tick() override {
+                if(finished()) {
+                    return true;
+                }
+
+                uint64_t now = uptimeMicros();
+
+                while(this->index < COUNT) {
+                    if(!this->entered) {
+                        Dispatch<0>::enter(this->steps, this->index, now, this);
+                        this->entered = true;
+                    }
+
+                    int result = Dispatch<0>::poll(this->steps, this->index, now);
+
+                    if(result == step::WAIT) {
+                        return true;
+                    }
+
+                    this->entered = false;
+                    this->index = result == step::NEXT ? this->index + 1 : COUNT;
+                }
+
+                // Start the next run on the next tick, so a chain without waits can't spin
+                if(this->looping) {
+                    this->index = 0;
+                }
+
+                return true;
+            }
+
+            /**
+             * @brief Get the time at which the current step needs its next tick
+             * @return uint64_t End of a delay or edge timeout, NEVER while queued on a semaphore,
+             * waiting for an edge without timeout or finished,
+             * 0 otherwise
+             */
+            uint64_t deadline() override {
+                if(finished()) {
+                    return NEVER;
+                }
+
+                if(!this->entered) {
+                    return 0;
+                }
+
+                return Dispatch<0>::deadline(this->steps, this->index);
+            }
+
+            uint64_t wakeTime() override {
+                if(finished()) {
+                    return NEVER;
+                }
+
+                if(!this->entered) {
+                    return 0;
+                }
+
+                return Dispatch<0>::wakeTime(this->steps, this->index);
+            }
+    };
+
+    /**
+     * @brief Build a StaticChain from steps
+     * @param steps Steps created with the factories of namespace step
+     * @return StaticChain Chain holding copies of the steps
+     */
+    template<typename... Steps>
+    StaticChain<typename std::decay<Steps>::type...> makeChain(Steps &&... steps) {
+        return StaticChain<typename std::decay<Steps>::type...>(std::forward<Steps>(steps)...);
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file Stats.h
+ * @brief Defines the runtime counters collected when ASYNC_STATS is enabled.
+ */
+
+namespace async {
+    /**
+     * @brief Runtime counters of one Tick object, updated by the Executor
+     */
+    struct TickStats {
+        uint32_t runs = 0;          ///< Number of dispatches, every pass for polled objects
+        uint64_t totalMicros = 0;   ///< Cumulative execution time
+        uint32_t maxMicros = 0;     ///< Longest single execution
+        uint32_t fired = 0;         ///< Dispatches of a timed Task that reached its deadline
+        uint64_t totalLateMicros = 0; ///< Cumulative lateness of those dispatches
+        uint32_t maxLateMicros = 0; ///< Largest lateness vs. the scheduled time
+
+        /**
+         * @brief Average execution time
+         * @return uint32_t Microseconds per dispatch
+         */
+        uint32_t averageMicros() const {
+            return runs > 0 ? totalMicros / runs : 0;
+        }
+
+        /**
+         * @brief Average lateness of timed dispatches
+         * @return uint32_t Microseconds after the deadline
+         */
+        uint32_t averageLateMicros() const {
+            return fired > 0 ? totalLateMicros / fired : 0;
+        }
+    };
+
+    /**
+     * @brief Loop counters of one Executor
+     */
+    struct ExecutorStats {
+        static int const BUCKETS = 16; ///< Histogram buckets
+
+        uint64_t since = 0;        ///< uptimeMicros() when collection started
+        uint32_t passes = 0;       ///< Number of tick() calls
+        uint64_t busyMicros = 0;   ///< Time spent inside tick()
+        uint32_t maxMicros = 0;    ///< Longest tick()
+        /**
+         * @brief tick() durations, bucket i counts passes shorter than 2^i µs,
+         * the last bucket counts everything longer
+         */
+        uint32_t histogram[BUCKETS] = {};
+
+        /**
+         * @brief Record one tick() call
+         * @param micros Duration of the call
+         */
+        void record(uint32_t micros) {
+            int bucket = 0;
+
+            while(bucket < BUCKETS - 1 && micros >= (1UL << bucket)) {
+                bucket++;
+            }
+
+            passes++;
+            busyMicros += micros;
+            histogram[bucket]++;
+
+            if(micros > maxMicros) {
+                maxMicros = micros;
+            }
+        }
+
+        /**
+         * @brief Number of tick() calls per second
+         * @param now Current uptimeMicros() time
+         * @return uint32_t Loop frequency in Hz
+         */
+        uint32_t loopFrequency(uint64_t now) const {
+            return now > since ? (uint64_t) passes * 1000000ULL / (now - since) : 0;
+        }
+
+        /**
+         * @brief Share of time spent outside tick()
+         * @param now Current uptimeMicros() time
+         * @return float Idle ratio between 0 and 1
+         */
+        float idleRatio(uint64_t now) const {
+            return now > since && busyMicros < now - since ? 1.0f - (float) busyMicros / (now - since) : 0.0f;
+        }
+    };
+}
@@ -3,6 +3,10 @@
 #include <async/Time.h>
 #include <async/Duration.h>
 #include <async/Callbacks.h>
+#include <async/Sleep.h>
+#include <async/Config.h>
+#include <async/Pool.h>
+#include <async/Trace.h>
 
 /**
  * @class Task
@@ -18,11 +22,49 @@ namespace async {
             int type;           ///< Task type (REPEAT, DELAY, etc.)
             volatile int state;          ///< Current state (PAUSE, RUN, CANCEL)
             int pin;
-            Duration * duration;///< Duration for timed tasks
-            Duration * from;    ///< Timestamp when task started or was last reset
+            Duration * duration = nullptr;///< Duration for timed tasks
+            Duration interval = Duration(0); ///< Storage for durations owned by the task
+            uint64_t from = 0;    ///< Time in microseconds when task started or was last reset
             VoidCallback callback; ///< Callback function to execute
+            int policy = 0;       ///< Repeat policy (FIXED_DELAY, CATCH_UP, etc.)
+            uint32_t overruns = 0;///< Periods that could not run on time (fixed-rate policies)
+
+            /**
+             * @brief Start the next period of a REPEAT task
+             * @param now Current time in microseconds, at least one period after 'from'
+             * @return true if the callback should run for the period that just ended
+             */
+            bool advance(uint64_t now) {
+                uint64_t period = this->duration->get(Duration::MICRO);
+
+                if(this->policy == FIXED_DELAY || period == 0) {
+                    this->from = now;
+                    return true;
+                }
+
+                uint64_t periods = (now - this->from) / period;
+
+                if(this->policy == CATCH_UP) {
+                    this->from += period;
+
+                    if(periods > 1) {
+                        this->overruns++;
+                    }
+
+                    return true;
+                }
+
+                this->from += periods * period;
+                this->overruns += periods - 1;
+
+                return this->policy == COALESCE || periods == 1;
+            }
 
         public:
+#if ASYNC_TASK_POOL_SIZE > 0
+            ASYNC_POOLED(Task, ASYNC_TASK_POOL_SIZE)
+#endif
+
             ///@name Task Type Constants
             ///@{
             static int const REPEAT = 0;      ///< Repeating task type
@@ -41,6 +83,14 @@ namespace async {
             //static LinkedList<async::Task*> handlers[];
             ///@}
 
+            ///@name Repeat Policy Constants
+            ///@{
+            static int const FIXED_DELAY = 0; ///< Next period starts when the callback runs, lateness accumulates
+            static int const CATCH_UP = 1;    ///< Fixed rate, every missed period is run as soon as possible
+            static int const COALESCE = 2;    ///< Fixed rate, missed periods are merged into one late run
+            static int const SKIP = 3;        ///< Fixed rate, late runs are dropped until the next period boundary
+            ///@}
+
             /**
              * @brief Destructor
              */
@@ -49,10 +99,6 @@ namespace async {
                 //detachInterrupt(digitalPinToInterrupt(pin));
                 //int val = digitalPinToInterrupt(pin);
                 //handlers[val].remove(this);
-
-                if(from != nullptr) {
-                    delete from;
-                }
             }
 
             /**
@@ -63,7 +109,7 @@ namespace async {
             Task(const int type, VoidCallback callback) {
                 this->type = type;
                 this->state = PAUSE;
-                this->callback = callback;
+                this->callback = std::move(callback);
             }
 
             /**
@@ -110,8 +156,39 @@ namespace async {
             Task(const int type, Duration * duration, VoidCallback callback) {
                 this->type = type;
                 this->duration = duration;
-                this->from = new Duration(millis());
-                this->callback = callback;
+                this->state = PAUSE;
+                this->from = uptimeMicros();
+                this->callback = std::move(callback);
+            }
+
+            /**
+             * @brief Construct a timed Task that owns its duration
+             * @param type Task type (REPEAT, DELAY, etc.)
+             * @param ms Task timing in milliseconds
+             * @param callback Function to execute when task triggers
+             *
+             * @note Use getDuration() to change the timing later
+             */
+            Task(const int type, uint64_t ms, VoidCallback callback) : Task(type, &interval, std::move(callback)) {
+                this->interval.set(ms);
+            }
+
+            /**
+             * @brief Construct a timed Task that owns a copy of its duration
+             * @param type Task type (REPEAT or DELAY)
+             * @param duration Task timing, e.g. Duration::us(250) for sub-millisecond periods
+             * @param callback Function to execute
+             */
+            Task(const int type, Duration duration, VoidCallback callback) : Task(type, &interval, std::move(callback)) {
+                this->interval = duration;
+            }
+
+            /**
+             * @brief Get the duration driving a timed task
+             * @return Duration* Duration object, nullptr for untimed tasks
+             */
+            Duration * getDuration() {
+                return this->duration;
             }
             
             ///@name Task Control Methods
@@ -144,6 +221,7 @@ namespace async {
              */
             bool resume() {
                 this->state = RUN;
+                this->wake();
                 return true;
             }
 
@@ -153,6 +231,8 @@ namespace async {
              */
             bool cancel() {
                 this->state = CANCEL;
+                // A parked task must be ticked once more to be removed
+                this->wake();
                 return true;
             }
 
@@ -162,7 +242,9 @@ namespace async {
              */
             bool demand() {
                 //Serial.println("demand");
+                ASYNC_TRACE_EVENT(Trace::INSTANT, Trace::DEMAND, this, 0);
                 this->state = RUN;
+                this->wake();
                 return true;
             }
 
@@ -171,11 +253,70 @@ namespace async {
              * @return Always returns true
              */
             bool reset() {
-                this->from->set(millis());
+                this->from = uptimeMicros();
                 return true;
             }
             ///@}
 
+            /**
+             * @brief Select how a REPEAT task schedules its periods
+             * @param policy FIXED_DELAY (default), CATCH_UP, COALESCE or SKIP
+             * @return Task* This task, for chaining
+             *
+             * @details With the fixed-rate policies the period boundaries stay at
+             * start + n * duration no matter how late a callback runs, so the task does not
+             * drift under load. The policy decides what happens to periods that were missed
+             * entirely; every missed period is counted in getOverruns().
+             */
+            Task * setPolicy(int policy) {
+                this->policy = policy;
+                return this;
+            }
+
+            /**
+             * @brief Get the repeat policy
+             * @return int FIXED_DELAY, CATCH_UP, COALESCE or SKIP
+             */
+            int getPolicy() {
+                return this->policy;
+            }
+
+            /**
+             * @brief Get the number of periods that could not run on time
+             * @return uint32_t Overrun counter (fixed-rate policies only)
+             */
+            uint32_t getOverruns() {
+                return this->overruns;
+            }
+
+            /**
+             * @brief Check whether the task is driven by its Duration
+             * @return true for DELAY and REPEAT tasks
+             */
+            bool isTimed() {
+                return this->type == Task::DELAY || this->type == Task::REPEAT;
+            }
+
+            /**
+             * @brief Get the time at which a running timed task fires next
+             * @return uint64_t Absolute time in microseconds, NEVER while paused, 0 for
+             * other untimed or inactive tasks
+             *
+             * @details Paused tasks, including DEMAND tasks waiting for demand(), are
+             * parked by the executor until resume(), demand() or cancel() wakes them.
+             */
+            uint64_t deadline() override {
+                if(this->state == Task::PAUSE) {
+                    return NEVER;
+                }
+
+                if(this->state != Task::RUN || !this->isTimed()) {
+                    return 0;
+                }
+
+                return this->from + this->duration->get(Duration::MICRO);
+            }
+
             /**
              * @brief Execute task tick logic
              * @return true if task should continue, false if task should be removed
@@ -183,29 +324,39 @@ namespace async {
              * @details Handles task execution based on type and state:
              * - TICK tasks execute every call
              * - DEMAND tasks execute once then pause
-             * - TIMED tasks check duration before executing
-             * - REPEAT tasks auto-reset after execution
+             * - TIMED tasks execute once their duration has elapsed
+             * - REPEAT tasks start their next period according to the repeat policy
              */
             bool tick() {
+                return this->expire(this->isTimed() ? uptimeMicros() : 0);
+            }
+
+            /**
+             * @brief Execute task tick logic against a timestamp read by the scheduler
+             * @param now Current time in microseconds, only used by timed tasks
+             * @return true if task should continue, false if task should be removed
+             */
+            bool expire(uint64_t now) override {
                 if(this->state == Task::RUN) {
                     if(this->type == Task::TICK) {
                         this->callback();
                     }
                     else if(this->type == Task::DEMAND) {
+                        // Pause first, so a demand() made during the callback is kept
+                        this->state = Task::PAUSE;
                         this->callback();
-                        this->pause();
                     }
-                    else if(millis() - this->from->get() > this->duration->get() && 
-                           (this->type == Task::DELAY || this->type == Task::REPEAT)) {
-                        this->callback();
-
-                        if(this->type == Task::REPEAT) {
-                            this->reset();
-                        }
-                        else {
+                    // reset() earlier in the same pass may have moved 'from' past 'now'
+                    else if(this->isTimed() && now >= this->from && now - this->from >= this->duration->get(Duration::MICRO)) {
+                        if(this->type == Task::DELAY) {
+                            this->callback();
                             this->cancel();
                             return false;
                         }
+
+                        if(this->advance(now)) {
+                            this->callback();
+                        }
                     }
                 }
                 else if(this->state == Task::CANCEL) {
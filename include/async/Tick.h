@@ -1,4 +1,11 @@
 #pragma once
+#include <stdint.h>
+#include <atomic>
+#include <async/Config.h>
+
+#if ASYNC_STATS
+    #include <async/Stats.h>
+#endif
 
 /**
  * @file
@@ -38,12 +45,150 @@
  * 
  * // Usage:
  * MyComponent comp;
+ * comp.setOwned(false); // static object, the executor must not delete it
  * executor.add(&comp);
  * @endcode
  */
 namespace async { 
+    class TimerQueue;
+    class TickList;
+    class WakeQueue;
+    class Semaphore;
+
     class Tick {
+    private:
+        friend class TimerQueue;
+        friend class TickList;
+        friend class WakeQueue;
+        friend class Semaphore;
+
+        /**
+         * @brief Entries of a WakeQueue and a Semaphore waiter queue, not copied along
+         * with the Tick
+         */
+        struct WakeLink {
+            std::atomic<bool> queued;       ///< Stored in the queue, set by wake()
+            Tick * next = nullptr;          ///< Next element inside the queue
+            std::atomic<WakeQueue *> queue; ///< Queue of the executor managing the object
+            std::atomic<int> pushing;       ///< wake() calls and notifications using the object
+            Tick * waitNext = nullptr;      ///< Next waiter of the Semaphore the object waits for
+
+            WakeLink() : queued(false), queue(nullptr), pushing(0) {}
+            WakeLink(const WakeLink &) : queued(false), queue(nullptr), pushing(0) {}
+            WakeLink & operator=(const WakeLink &) { return *this; }
+        };
+
+        uint64_t timerDue = 0;      ///< Due time while stored in a TimerQueue
+        int timerSlot = -1;         ///< Heap slot inside a TimerQueue, -1 if not queued
+        Tick * listPrev = nullptr;  ///< Previous element inside a TickList
+        Tick * listNext = nullptr;  ///< Next element inside a TickList
+        TickList * list = nullptr;  ///< TickList holding the object, nullptr if not linked
+        int affinity = -1;          ///< Worker the object is pinned to, ANY if it may migrate
+        int priority = 1;           ///< Dispatch level, PRIORITY_NORMAL by default
+        bool owned = true;          ///< Deleted by the executor it leaves
+        WakeLink wakeLink;          ///< Entry of the wake() queue
+#if ASYNC_STATS || ASYNC_TRACE
+        const char * name = nullptr; ///< Name shown in statistics reports and traces
+#endif
+#if ASYNC_STATS
+        TickStats stats;            ///< Runtime counters, updated by the Executor
+#endif
+
     public:
+        static const uint64_t NEVER = (uint64_t)-1; ///< No deadline, the object waits for an event
+        static int const ANY = -1; ///< Affinity of objects that may run on any worker
+
+        ///@name Priority Constants
+        ///@{
+        static int const PRIORITY_LOW = 0;    ///< Runs after everything else, first to be deferred
+        static int const PRIORITY_NORMAL = 1; ///< Default level
+        static int const PRIORITY_HIGH = 2;   ///< Runs first within a pass, e.g. control loops
+        static int const PRIORITY_LEVELS = 3; ///< Number of priority levels
+        ///@}
+
+        /**
+         * @brief Set the dispatch priority
+         * @param level PRIORITY_LOW, PRIORITY_NORMAL (default) or PRIORITY_HIGH
+         *
+         * @details Within one Executor pass higher levels run first. A change takes
+         * effect from the next time the object is dispatched.
+         */
+        void setPriority(int level) {
+            priority = level < PRIORITY_LOW ? PRIORITY_LOW : level > PRIORITY_HIGH ? PRIORITY_HIGH : level;
+        };
+
+        /**
+         * @brief Attach a name shown in statistics reports and traces
+         * @param name Static string, not copied
+         *
+         * @note Does nothing unless ASYNC_STATS or ASYNC_TRACE is enabled
+         */
+        void setName(const char * name) {
+#if ASYNC_STATS || ASYNC_TRACE
+            this->name = name;
+#else
+            (void) name;
+#endif
+        };
+
+        /**
+         * @brief Get the name attached with setName()
+         * @return const char* Name, or an empty string if none is set or names are compiled out
+         */
+        const char * getName() {
+#if ASYNC_STATS || ASYNC_TRACE
+            return name != nullptr ? name : "";
+#else
+            return "";
+#endif
+        };
+
+#if ASYNC_STATS
+        /**
+         * @brief Get the runtime counters of the object
+         * @return TickStats& Counters, reset with stats = TickStats()
+         */
+        TickStats & getStats() { return stats; };
+#endif
+
+        /**
+         * @brief Get the dispatch priority
+         * @return int Priority level
+         */
+        int getPriority() { return priority; };
+
+        /**
+         * @brief Pin the object to one worker of a MultiExecutor
+         * @param worker Worker index, or ANY to allow migration (default)
+         *
+         * @details Use it for callbacks that must stay on one core, e.g. code touching
+         * WiFi or the RTC. Pinned objects are never stolen by other workers.
+         * Single-threaded executors ignore the hint.
+         */
+        void setAffinity(int worker) { affinity = worker; };
+
+        /**
+         * @brief Get the worker the object is pinned to
+         * @return int Worker index, or ANY
+         */
+        int getAffinity() { return affinity; };
+
+        /**
+         * @brief Choose whether executors delete the object when it leaves them
+         * @param owned true (default) for heap objects handed over to the executor,
+         * false for objects in static storage or on the stack
+         *
+         * @details A Tick that is not owned is still cancel()ed when it finishes or is
+         * removed, but never deleted.
+         */
+        void setOwned(bool owned) { this->owned = owned; };
+
+        /**
+         * @brief Check whether executors delete the object when it leaves them
+         * @return bool true unless setOwned(false) was called
+         */
+        bool isOwned() { return owned; };
+
         /**
          * @brief Process a single tick
          * @return bool True to continue receiving ticks, false to unsubscribe
@@ -91,9 +236,61 @@ namespace async {
          */
         virtual bool cancel() { return true; };
 
+        /**
+         * @brief Get the earliest time at which the object needs its next tick
+         * @return uint64_t Absolute uptimeMicros() time, 0 if it must be ticked on every pass,
+         * NEVER if it waits for wake()
+         *
+         * @details Timer-mode executors use this value to keep the object out of
+         * the polling list until it is due. Objects reporting NEVER are parked by every
+         * Executor and not ticked again until wake() is called, so waiting objects cost
+         * nothing per pass.
+         *
+         * @note Default implementation returns 0
+         */
+        virtual uint64_t deadline() { return 0; };
+
+        /**
+         * @brief Make the object runnable again, e.g. after the event it waits for
+         *
+         * @details Moves a parked object back to the polling list of its Executor at the
+         * start of the next pass, and ends a pending sleep() of that Executor only. Safe
+         * to call from an interrupt, another core or another thread, and for objects that
+         * are not parked. Objects managed by no executor are not affected. Defined in
+         * WakeQueue.h.
+         */
+        void wake();
+
+        /**
+         * @brief Process a tick issued by a scheduler after deadline() has passed
+         * @param now Current uptimeMicros() time, as read once by the scheduler
+         * @return bool True to continue receiving ticks, false to unsubscribe
+         *
+         * @note Default implementation ignores the timestamp and calls tick()
+         */
+        virtual bool expire(uint64_t now) {
+            (void) now;
+            return tick();
+        };
+
+        /**
+         * @brief Get the earliest time at which the object may have work to do
+         * @return uint64_t Absolute uptimeMicros() time, 0 if it has work now,
+         * NEVER if it only becomes active after an event such as Task::demand()
+         *
+         * @details Used by Executor::sleep() to compute how long the loop can idle.
+         * Unlike deadline(), the value may be cut short by an event that calls
+         * wake().
+         *
+         * @note Default implementation returns deadline()
+         */
+        virtual uint64_t wakeTime() { return deadline(); };
+
         /**
          * @brief Virtual destructor
          */
         virtual ~Tick() = default;
     };
-}
\ No newline at end of file
+}
+
+#include <async/WakeQueue.h>
@@ -0,0 +1,168 @@
+#pragma once
+#include <async/Tick.h>
+#include <stddef.h>
+
+/**
+ * @file TickList.h
+ * @brief Defines the async::TickList intrusive list used by executors.
+ */
+
+namespace async {
+    /**
+     * @class TickList
+     * @brief Intrusive doubly-linked list of Tick objects
+     *
+     * @details The links live inside the Tick itself, so insertion and removal are O(1)
+     * and never allocate. Every Tick remembers the list it belongs to, which lets an
+     * executor unlink an object without knowing in advance where it is stored.
+     *
+     * @note A Tick can be stored in at most one TickList at a time.
+     */
+    class TickList {
+        private:
+            Tick * head = nullptr; ///< First element
+            Tick * tail = nullptr; ///< Last element
+            size_t count = 0;      ///< Number of elements
+
+        public:
+            /**
+             * @brief Append a Tick to the end of the list
+             * @param tick Tick to append, must not be stored in any list
+             */
+            void pushBack(Tick * tick) {
+                tick->listPrev = tail;
+                tick->listNext = nullptr;
+                tick->list = this;
+
+                if(tail != nullptr) {
+                    tail->listNext = tick;
+                }
+                else {
+                    head = tick;
+                }
+
+                tail = tick;
+                count++;
+            }
+
+            /**
+             * @brief Unlink a Tick from the list
+             * @param tick Tick to unlink
+             * @return true if the Tick was stored in this list
+             */
+            bool remove(Tick * tick) {
+                if(tick->list != this) {
+                    return false;
+                }
+
+                if(tick->listPrev != nullptr) {
+                    tick->listPrev->listNext = tick->listNext;
+                }
+                else {
+                    head = tick->listNext;
+                }
+
+                if(tick->listNext != nullptr) {
+                    tick->listNext->listPrev = tick->listPrev;
+                }
+                else {
+                    tail = tick->listPrev;
+                }
+
+                tick->listPrev = nullptr;
+                tick->listNext = nullptr;
+                tick->list = nullptr;
+                count--;
+                return true;
+            }
+
+            /**
+             * @brief Move every element of another list to the end of this one
+             * @param other Source list, empty afterwards
+             */
+            void splice(TickList & other) {
+                for(Tick * tick = other.head; tick != nullptr; tick = tick->listNext) {
+                    tick->list = this;
+                }
+
+                if(other.head == nullptr) {
+                    return;
+                }
+
+                if(tail != nullptr) {
+                    tail->listNext = other.head;
+                    other.head->listPrev = tail;
+                }
+                else {
+                    head = other.head;
+                }
+
+                tail = other.tail;
+                count += other.count;
+                other.head = other.tail = nullptr;
+                other.count = 0;
+            }
+
+            /**
+             * @brief Make an element the head, moving the elements before it to the end
+             * @param tick Element of this list
+             *
+             * @details Keeps the cyclic order, so iteration can resume from the element
+             * where an earlier iteration stopped.
+             */
+            void rotate(Tick * tick) {
+                if(tick->list != this || tick == head) {
+                    return;
+                }
+
+                tail->listNext = head;
+                head->listPrev = tail;
+                tail = tick->listPrev;
+                tail->listNext = nullptr;
+                tick->listPrev = nullptr;
+                head = tick;
+            }
+
+            /**
+             * @brief Get the first element
+             * @return Tick* First Tick, or nullptr if the list is empty
+             */
+            Tick * first() const {
+                return head;
+            }
+
+            /**
+             * @brief Get the element following a Tick
+             * @param tick Tick stored in a list
+             * @return Tick* Next Tick, or nullptr at the end of the list
+             */
+            static Tick * next(Tick * tick) {
+                return tick->listNext;
+            }
+
+            /**
+             * @brief Get the list a Tick is stored in
+             * @param tick Tick to check
+             * @return TickList* Owning list, or nullptr if the Tick is not linked
+             */
+            static TickList * of(Tick * tick) {
+                return tick->list;
+            }
+
+            /**
+             * @brief Number of elements
+             * @return size_t List size
+             */
+            size_t size() const {
+                return count;
+            }
+
+            /**
+             * @brief Check whether the list is empty
+             * @return true if the list has no elements
+             */
+            bool empty() const {
+                return head == nullptr;
+            }
+    };
+}
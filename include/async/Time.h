@@ -50,7 +50,6 @@ inline void writeFourDigits(char* ptr, int value) {
 namespace async { 
   class Time : public Duration {
     private:
-      uint64_t valueMillis; ///< Internal timestamp storage in milliseconds
       static Time SYSTEM_TIME; ///< Static system time reference
       
       ///@name Time Conversion Constants
@@ -84,6 +83,45 @@ namespace async {
           return 31;
       }
 
+      /**
+       * @brief Number of days from 1970-01-01 to a civil date
+       * @param year Full year
+       * @param month Month (1-12)
+       * @param day Day of month (1-31)
+       * @return int32_t Days since epoch, negative before 1970
+       *
+       * @details Howard Hinnant's days_from_civil: the year is shifted to start in March,
+       * so the leap day is the last day of the year and month lengths follow a fixed
+       * 153-day pattern. Constant time, 32-bit arithmetic only.
+       */
+      static int32_t daysFromCivil(int32_t year, uint32_t month, uint32_t day) {
+        year -= month <= 2;
+        int32_t era = (year >= 0 ? year : year - 399) / 400;
+        uint32_t yoe = (uint32_t) (year - era * 400);                               // [0, 399]
+        uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1; // [0, 365]
+        uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;                         // [0, 146096]
+        return era * 146097 + (int32_t) doe - 719468;
+      }
+
+      /**
+       * @brief Civil date of a day number, the inverse of daysFromCivil()
+       * @param days Days since 1970-01-01
+       * @param[out] year Full year
+       * @param[out] month Month (1-12)
+       * @param[out] day Day of month (1-31)
+       */
+      static void civilFromDays(int32_t days, int32_t &year, uint32_t &month, uint32_t &day) {
+        days += 719468;
+        int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+        uint32_t doe = (uint32_t) (days - era * 146097);                              // [0, 146096]
+        uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;         // [0, 399]
+        uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);                       // [0, 365]
+        uint32_t mp = (5 * doy + 2) / 153;                                            // [0, 11]
+        day = doy - (153 * mp + 2) / 5 + 1;
+        month = mp < 10 ? mp + 3 : mp - 9;
+        year = (int32_t) yoe + era * 400 + (month <= 2);
+      }
+
     public:
       /**
        * @brief Construct a Time object from milliseconds
@@ -102,21 +140,7 @@ namespace async {
        * @param millisecond Millisecond (0-999)
        */
       void setTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second, uint16_t millisecond) {
-        // Calculate total days since epoch
-        uint64_t days = 0;
-        
-        // Days from full years
-        for (uint16_t y = 1970; y < year; ++y) {
-            days += isLeapYear(y) ? 366 : 365;
-        }
-        
-        // Days from full months
-        for (uint8_t m = 1; m < month; ++m) {
-            days += getDaysInMonth(year, m);
-        }
-        
-        // Days from current month
-        days += day - 1;
+        uint64_t days = (uint64_t) (int64_t) daysFromCivil(year, month, day);
 
         // Calculate total milliseconds
         uint64_t timestamp = days * MS_PER_DAY;
@@ -125,7 +149,7 @@ namespace async {
         timestamp += second * MS_PER_SECOND;
         timestamp += millisecond;
 
-        this->valueMillis = timestamp;
+        this->set(timestamp);
       }
 
       /**
@@ -139,44 +163,39 @@ namespace async {
        * @param[out] millisecond Reference to store millisecond (0-999)
        */
       void getTime(uint16_t &year, uint8_t &month, uint8_t &day, uint8_t &hour, uint8_t &minute, uint8_t &second, uint16_t &millisecond) {
-        uint64_t timestamp = getTimestamp();
-        millisecond = timestamp % 1000;
-        uint64_t total_seconds = timestamp / 1000;
-        
-        second = total_seconds % 60;
-        uint64_t total_minutes = total_seconds / 60;
-        
-        minute = total_minutes % 60;
-        uint64_t total_hours = total_minutes / 60;
-        
-        hour = total_hours % 24;
-        uint64_t total_days = total_hours / 24;
-    
-        // Calculate year
-        year = 1970;
-        while(true) {
-            uint16_t days_in_year = isLeapYear(year) ? 366 : 365;
-            if(total_days >= days_in_year) {
-                total_days -= days_in_year;
-                year++;
-            } else {
-                break;
-            }
-        }
-    
-        // Calculate month and day
-        month = 1;
-        while(month <= 12) {
-            uint8_t dim = getDaysInMonth(year, month);
-            if(total_days >= dim) {
-                total_days -= dim;
-                month++;
-            } else {
-                break;
-            }
-        }
+        getTime(getTimestamp(), year, month, day, hour, minute, second, millisecond);
+      }
 
-        day = total_days + 1;  // Days start at 1
+      /**
+       * @brief Convert a given timestamp to calendar date components
+       * @param timestamp Milliseconds since Unix epoch (1970-01-01)
+       * @param[out] year Reference to store year
+       * @param[out] month Reference to store month (1-12)
+       * @param[out] day Reference to store day (1-31)
+       * @param[out] hour Reference to store hour (0-23)
+       * @param[out] minute Reference to store minute (0-59)
+       * @param[out] second Reference to store second (0-59)
+       * @param[out] millisecond Reference to store millisecond (0-999)
+       */
+      void getTime(uint64_t timestamp, uint16_t &year, uint8_t &month, uint8_t &day, uint8_t &hour, uint8_t &minute, uint8_t &second, uint16_t &millisecond) {
+        // One 64-bit division, everything below a day fits into 32 bits
+        uint32_t days = timestamp / MS_PER_DAY;
+        uint32_t rest = timestamp - (uint64_t) days * MS_PER_DAY;
+
+        millisecond = rest % 1000;
+        rest /= 1000;
+        second = rest % 60;
+        rest /= 60;
+        minute = rest % 60;
+        hour = rest / 60;
+
+        int32_t y;
+        uint32_t m, d;
+        civilFromDays(days, y, m, d);
+
+        year = y;
+        month = m;
+        day = d;
       }
 
       /**
@@ -184,7 +203,7 @@ namespace async {
        * @return uint64_t Milliseconds since Unix epoch (1970-01-01)
        */
       uint64_t getTimestamp() {
-        return millis() + this->valueMillis;
+        return Clock::millis() + this->get(MILLIS);
       }
 
       /**
@@ -192,7 +211,7 @@ namespace async {
        * @param ms Milliseconds since Unix epoch (1970-01-01)
        */
       void setTimestamp(uint64_t ms) {
-        this->valueMillis = ms;
+        this->set(ms);
       }
 
       /**
@@ -237,6 +256,19 @@ namespace async {
         formatDateTime(buffer, year, month, day, hour, minute, second, millisecond);
       }
 
+      /**
+       * @brief Format a given timestamp into a character buffer
+       * @param buffer Character buffer (must be at least 24 bytes)
+       * @param timestamp Milliseconds since Unix epoch (1970-01-01)
+       */
+      void toChar(char * buffer, uint64_t timestamp) {
+        uint16_t year, millisecond;
+        uint8_t month, day, hour, minute, second;
+
+        getTime(timestamp, year, month, day, hour, minute, second, millisecond);
+        formatDateTime(buffer, year, month, day, hour, minute, second, millisecond);
+      }
+
       /**
        * @brief Convert time to formatted String object
        * @return String Formatted as "YYYY-MM-DD HH:MM:SS.MMM"
@@ -300,7 +332,7 @@ namespace async {
        * @note Caller is responsible for memory management
        */
       static Time * now() {
-        return new Time(millis());
+        return new Time(Clock::millis());
       };
 
       /**
@@ -323,4 +355,42 @@ namespace async {
       };
       ///@}
   };
+
+  /**
+   * @class TimeFormatter
+   * @brief Formats timestamps as "YYYY-MM-DD HH:MM:SS.MMM" with a cached prefix
+   *
+   * @details The text up to the seconds is kept for the second of the last call. While
+   * timestamps stay within that second only the three millisecond digits are rewritten,
+   * without any 64-bit division or calendar math.
+   *
+   * @note Not thread-safe, use one formatter per context
+   */
+  class TimeFormatter {
+    private:
+      char prefix[24];                ///< Formatted text of the cached second
+      uint64_t second = 0;            ///< Timestamp of the start of the cached second
+      bool valid = false;             ///< prefix holds the text of 'second'
+
+    public:
+      /**
+       * @brief Format a timestamp
+       * @param buffer Character buffer (must be at least 24 bytes)
+       * @param timestamp Milliseconds since Unix epoch (1970-01-01)
+       */
+      void format(char * buffer, uint64_t timestamp) {
+        uint64_t offset = timestamp - this->second;
+
+        if(!this->valid || offset >= 1000) {
+          Time::getSystem().toChar(this->prefix, timestamp);
+          offset = (this->prefix[20] - '0') * 100 + (this->prefix[21] - '0') * 10 + (this->prefix[22] - '0');
+          this->second = timestamp - offset;
+          this->valid = true;
+        }
+
+        memcpy(buffer, this->prefix, 20);
+        writeThreeDigits(buffer + 20, (int) offset);
+        buffer[23] = '\0';
+      }
+  };
 };
\ No newline at end of file
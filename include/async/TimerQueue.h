@@ -0,0 +1,193 @@
+#pragma once
+#include <async/Tick.h>
+#include <vector>
+
+/**
+ * @file TimerQueue.h
+ * @brief Defines the async::TimerQueue min-heap used by timer-mode executors.
+ */
+
+namespace async {
+    /**
+     * @class TimerQueue
+     * @brief Binary min-heap of Tick objects keyed on their absolute due time
+     *
+     * @details The queue keeps the earliest due Tick at the top, so a scheduler only
+     * has to look at the top entry to know whether anything is ready. Every Tick
+     * remembers its own slot inside the heap, which makes removal of an arbitrary
+     * entry O(log n) instead of a linear search.
+     *
+     * @note A Tick can be stored in at most one TimerQueue at a time.
+     */
+    class TimerQueue {
+        private:
+            std::vector<Tick*> heap; ///< Heap storage, heap[0] is the earliest due Tick
+
+            /**
+             * @brief Store a Tick in a heap slot and update its back reference
+             * @param slot Heap index
+             * @param tick Tick to store
+             */
+            void place(int slot, Tick * tick) {
+                heap[slot] = tick;
+                tick->timerSlot = slot;
+            }
+
+            /**
+             * @brief Move an entry towards the root until the heap order is restored
+             * @param slot Heap index of the entry
+             */
+            void siftUp(int slot) {
+                Tick * tick = heap[slot];
+
+                while(slot > 0) {
+                    int parent = (slot - 1) / 2;
+
+                    if(heap[parent]->timerDue <= tick->timerDue) {
+                        break;
+                    }
+
+                    place(slot, heap[parent]);
+                    slot = parent;
+                }
+
+                place(slot, tick);
+            }
+
+            /**
+             * @brief Move an entry towards the leaves until the heap order is restored
+             * @param slot Heap index of the entry
+             */
+            void siftDown(int slot) {
+                int size = heap.size();
+                Tick * tick = heap[slot];
+
+                while(true) {
+                    int child = slot * 2 + 1;
+
+                    if(child >= size) {
+                        break;
+                    }
+
+                    if(child + 1 < size && heap[child + 1]->timerDue < heap[child]->timerDue) {
+                        child++;
+                    }
+
+                    if(tick->timerDue <= heap[child]->timerDue) {
+                        break;
+                    }
+
+                    place(slot, heap[child]);
+                    slot = child;
+                }
+
+                place(slot, tick);
+            }
+
+        public:
+            /**
+             * @brief Insert a Tick with the given due time
+             * @param tick Tick to schedule, must not already be queued
+             * @param due Absolute due time in microseconds
+             */
+            void push(Tick * tick, uint64_t due) {
+                tick->timerDue = due;
+                heap.push_back(tick);
+                siftUp(heap.size() - 1);
+            }
+
+            /**
+             * @brief Get the earliest due Tick without removing it
+             * @return Tick* Earliest due Tick, or nullptr if the queue is empty
+             */
+            Tick * top() const {
+                return heap.empty() ? nullptr : heap.front();
+            }
+
+            /**
+             * @brief Get the due time of the earliest entry
+             * @return uint64_t Due time in microseconds, or the maximum value if empty
+             */
+            uint64_t nextDue() const {
+                return heap.empty() ? (uint64_t)-1 : heap.front()->timerDue;
+            }
+
+            /**
+             * @brief Remove and return the earliest due Tick
+             * @return Tick* Earliest due Tick, or nullptr if the queue is empty
+             */
+            Tick * pop() {
+                if(heap.empty()) {
+                    return nullptr;
+                }
+
+                Tick * tick = heap.front();
+                remove(tick);
+                return tick;
+            }
+
+            /**
+             * @brief Remove an arbitrary Tick from the queue
+             * @param tick Tick to remove
+             * @return true if the Tick was queued, false otherwise
+             */
+            bool remove(Tick * tick) {
+                int slot = tick->timerSlot;
+
+                if(slot < 0 || slot >= (int) heap.size() || heap[slot] != tick) {
+                    return false;
+                }
+
+                Tick * last = heap.back();
+                heap.pop_back();
+                tick->timerSlot = -1;
+
+                if(last != tick) {
+                    place(slot, last);
+
+                    if(slot > 0 && heap[(slot - 1) / 2]->timerDue > last->timerDue) {
+                        siftUp(slot);
+                    }
+                    else {
+                        siftDown(slot);
+                    }
+                }
+
+                return true;
+            }
+
+            /**
+             * @brief Get a queued Tick by heap slot, for iteration in no particular order
+             * @param slot Heap index below size()
+             * @return Tick* Queued Tick
+             */
+            Tick * at(size_t slot) const {
+                return heap[slot];
+            }
+
+            /**
+             * @brief Check whether a Tick is currently queued
+             * @param tick Tick to check
+             * @return true if queued
+             */
+            bool contains(Tick * tick) const {
+                return tick->timerSlot >= 0;
+            }
+
+            /**
+             * @brief Number of queued Ticks
+             * @return size_t Queue size
+             */
+            size_t size() const {
+                return heap.size();
+            }
+
+            /**
+             * @brief Check whether the queue is empty
+             * @return true if nothing is queued
+             */
+            bool empty() const {
+                return heap.empty();
+            }
+    };
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <Arduino.h>
+#include <async/Config.h>
+#include <async/Tick.h>
+
+/**
+ * @file Trace.h
+ * @brief Defines the async::Trace recorder and its Chrome Trace Event exporter.
+ */
+
+namespace async {
+    /**
+     * @class Trace
+     * @brief Fixed-size ring buffer of timestamped executor events
+     *
+     * @details When ASYNC_TRACE is enabled, executors, Tasks, Pins, Chains and States
+     * record what they do: a begin/end pair for every dispatch and State notification,
+     * and instant events for interrupts, demand() calls and Chain step transitions.
+     * Recording claims a slot with one atomic increment and fills in a 16-byte record,
+     * so it is cheap enough to stay enabled in the field. The buffer keeps the last
+     * ASYNC_TRACE_SIZE events. Executors skip polled objects whose wakeTime() lies in the
+ * future, so idle polling does not flush the buffer.
+     *
+     * dump() writes the buffer as Chrome Trace Event JSON, which chrome://tracing and
+     * ui.perfetto.dev open directly.
+     *
+     * @note Safe to record from interrupts and several cores. Events recorded while
+     * dump() runs may show up torn, so dump from a quiet moment.
+     */
+    class Trace {
+        public:
+            ///@name Event Phases
+            ///@{
+            static int const BEGIN = 0;   ///< Start of a span
+            static int const END = 1;     ///< End of the innermost open span
+            static int const INSTANT = 2; ///< Point event
+            ///@}
+
+            ///@name Event Kinds
+            ///@{
+            static int const DISPATCH = 0;   ///< Executor dispatch of a Tick
+            static int const INTERRUPT = 1;  ///< Pin interrupt
+            static int const DEMAND = 2;     ///< Task::demand(), e.g. from an ISR
+            static int const CHAIN_STEP = 3; ///< Chain moved to another step, arg is the step index (mod 256)
+            static int const STATE_SET = 4;  ///< State change callbacks
+            ///@}
+
+            /**
+             * @brief One recorded event
+             */
+            struct Event {
+                uint32_t time;       ///< micros() at recording
+                const void * object; ///< Object the event belongs to
+                const char * name;   ///< Tick::getName() at recording, may be empty
+                uint8_t phase;       ///< BEGIN, END or INSTANT
+                uint8_t kind;        ///< Event kind
+                uint8_t arg;         ///< Kind-specific argument
+                uint8_t core;        ///< Core that recorded the event
+            };
+
+            /**
+             * @brief Record an event, usually through the ASYNC_TRACE_EVENT macro
+             * @param phase BEGIN, END or INSTANT
+             * @param kind Event kind
+             * @param object Object the event belongs to
+             * @param arg Kind-specific argument
+             */
+            static void record(int phase, int kind, Tick * object, int arg = 0);
+
+            /**
+             * @brief Write the recorded events as Chrome Trace Event JSON
+             * @param out Destination, e.g. Serial or an open File
+             */
+            static void dump(Print & out);
+
+            /**
+             * @brief Discard every recorded event
+             */
+            static void clear();
+
+            /**
+             * @brief Number of events currently kept
+             * @return size_t Event count, at most ASYNC_TRACE_SIZE
+             */
+            static size_t size();
+    };
+}
+
+/**
+ * @brief Record a trace event, compiles to nothing unless ASYNC_TRACE is enabled
+ */
+#if ASYNC_TRACE
+    #define ASYNC_TRACE_EVENT(phase, kind, object, arg) async::Trace::record(phase, kind, object, arg)
+#else
+    #define ASYNC_TRACE_EVENT(phase, kind, object, arg) ((void) 0)
+#endif
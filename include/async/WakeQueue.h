@@ -0,0 +1,188 @@
+#pragma once
+#include <async/Tick.h>
+#include <async/Sleep.h>
+#include <atomic>
+
+#if defined(ARDUINO_ARCH_ESP32)
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/task.h>
+#elif !defined(ARDUINO)
+    #include <thread>
+#endif
+
+/**
+ * @file WakeQueue.h
+ * @brief Defines the async::WakeQueue used by executors to collect Tick::wake() calls.
+ */
+
+namespace async {
+    /**
+     * @class WakeQueue
+     * @brief Lock-free stack of woken Tick objects
+     *
+     * @details Any context may push, including interrupts and other cores; the executor
+     * owning the queue is the only consumer. The links live inside the Tick, and a Tick
+     * that is already queued is not pushed again, so pushing never allocates and never
+     * fails.
+     *
+     * Every push ends a wait of the owner's Sleep and wakes the owner itself, so the
+     * event travels up to the executor that runs the owner, e.g. from a child of a
+     * Parallel group or from an Executor nested in another one.
+     */
+    class WakeQueue {
+        private:
+            std::atomic<Tick *> head;   ///< Last pushed element
+            Tick * owner;               ///< Tick consuming the queue, woken on every push
+            Sleep * sleeper;            ///< Sleep of the loop consuming the queue, may be nullptr
+
+            /**
+             * @brief Put a Tick on top of the stack
+             * @param tick Tick whose queued flag is already set
+             */
+            void link(Tick * tick) {
+                Tick * top = head.load(std::memory_order_relaxed);
+
+                do {
+                    tick->wakeLink.next = top;
+                } while(!head.compare_exchange_weak(top, tick, std::memory_order_release, std::memory_order_relaxed));
+            }
+
+            /**
+             * @brief Let a wake() preempted by the consumer finish its push
+             */
+            static void pause() {
+#if defined(ARDUINO_ARCH_ESP32)
+                vTaskDelay(1);
+#elif !defined(ARDUINO)
+                std::this_thread::yield();
+#endif
+            }
+
+        public:
+            /**
+             * @brief Create a queue
+             * @param owner Tick that drains the queue, nullptr for none
+             * @param sleeper Sleep ended by every push, nullptr for none
+             */
+            explicit WakeQueue(Tick * owner = nullptr, Sleep * sleeper = nullptr)
+                : head(nullptr), owner(owner), sleeper(sleeper) {}
+
+            /**
+             * @brief Route the wake() calls of a Tick to this queue
+             * @param tick Tick managed by the owner of the queue
+             */
+            void attach(Tick * tick) {
+                tick->wakeLink.queue.store(this, std::memory_order_seq_cst);
+            }
+
+            /**
+             * @brief Stop routing the wake() calls of a Tick and drop it from the queue
+             * @param tick Tick about to leave the owner of the queue
+             *
+             * @details Waits for wake() calls that read the queue before it was detached,
+             * so the Tick may be deleted right after.
+             *
+             * @note Consumer side only
+             */
+            void detach(Tick * tick) {
+                WakeQueue * expected = this;
+                tick->wakeLink.queue.compare_exchange_strong(expected, nullptr, std::memory_order_seq_cst);
+
+                // Pairs with the increment in Tick::wake(): a producer either sees no
+                // queue, or is counted here until its push is linked
+                settle(tick);
+
+                if(!tick->wakeLink.queued.load(std::memory_order_acquire)) {
+                    return;
+                }
+
+                Tick * item = head.exchange(nullptr, std::memory_order_acquire);
+
+                while(item != nullptr) {
+                    Tick * next = item->wakeLink.next;
+
+                    if(item == tick) {
+                        item->wakeLink.queued.store(false, std::memory_order_release);
+                    }
+                    else {
+                        link(item);
+                    }
+
+                    item = next;
+                }
+            }
+
+            /**
+             * @brief Wait until no wake() call and no Semaphore notification uses a Tick
+             * @param tick Tick about to be deleted, no longer reachable for new callers
+             */
+            static void settle(Tick * tick) {
+                while(tick->wakeLink.pushing.load(std::memory_order_seq_cst) != 0) {
+                    pause();
+                }
+            }
+
+            /**
+             * @brief Queue a Tick unless it is queued already, and notify the owner
+             * @param tick Tick to queue
+             */
+            void push(Tick * tick) {
+                if(!tick->wakeLink.queued.exchange(true, std::memory_order_acq_rel)) {
+                    link(tick);
+                }
+
+                notify();
+            }
+
+            /**
+             * @brief End the owner's sleep and wake the owner
+             *
+             * @note Safe to call from interrupts and from other cores or threads
+             */
+            void notify() {
+                if(this->sleeper != nullptr) {
+                    this->sleeper->wake();
+                }
+
+                if(this->owner != nullptr) {
+                    this->owner->wake();
+                }
+            }
+
+            /**
+             * @brief Check whether no Tick is queued
+             */
+            bool empty() {
+                return head.load(std::memory_order_acquire) == nullptr;
+            }
+
+            /**
+             * @brief Take every queued Tick
+             * @param func Callable taking a Tick*, run for each of them
+             *
+             * @note Consumer side only. A Tick woken again while func runs is queued anew.
+             */
+            template<typename Func>
+            void drain(Func func) {
+                Tick * item = head.exchange(nullptr, std::memory_order_acquire);
+
+                while(item != nullptr) {
+                    Tick * next = item->wakeLink.next;
+                    item->wakeLink.queued.store(false, std::memory_order_release);
+                    func(item);
+                    item = next;
+                }
+            }
+    };
+
+    inline void Tick::wake() {
+        this->wakeLink.pushing.fetch_add(1, std::memory_order_seq_cst);
+        WakeQueue * queue = this->wakeLink.queue.load(std::memory_order_seq_cst);
+
+        if(queue != nullptr) {
+            queue->push(this);
+        }
+
+        this->wakeLink.pushing.fetch_sub(1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,81 @@
+#include <async/Clock.h>
+#include <atomic>
+
+#if ASYNC_CLOCK == ASYNC_CLOCK_POSIX
+    #include <time.h>
+#endif
+
+using namespace async;
+
+#if ASYNC_CLOCK == ASYNC_CLOCK_ARDUINO
+
+uint64_t Clock::micros() {
+    static std::atomic<uint64_t> last(0);
+    uint64_t previous = last.load();
+
+    while(true) {
+        // Read the counter after 'previous', so it can't be older than the stored value
+        uint64_t now = (previous & 0xFFFFFFFF00000000ULL) | (uint32_t) ::micros();
+
+        if(now < previous) {
+            now += 0x100000000ULL;
+        }
+
+        // Only publish once per half period, the common path stays a plain load
+        if((now >> 31) == (previous >> 31) || last.compare_exchange_weak(previous, now)) {
+            return now;
+        }
+    }
+}
+
+#elif ASYNC_CLOCK == ASYNC_CLOCK_POSIX
+
+uint64_t Clock::micros() {
+    static uint64_t const start = [] {
+        timespec time;
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return (uint64_t) time.tv_sec * 1000000ULL + time.tv_nsec / 1000;
+    }();
+
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t) time.tv_sec * 1000000ULL + time.tv_nsec / 1000 - start;
+}
+
+#elif ASYNC_CLOCK == ASYNC_CLOCK_VIRTUAL && defined(ASYNC_HOST)
+
+uint64_t Clock::micros() {
+    return host::clockMicros();
+}
+
+#elif ASYNC_CLOCK == ASYNC_CLOCK_VIRTUAL
+
+static std::atomic<uint64_t> virtualMicros(0);
+
+uint64_t Clock::micros() {
+    return virtualMicros.load(std::memory_order_acquire);
+}
+
+void Clock::set(uint64_t us) {
+    virtualMicros.store(us, std::memory_order_release);
+}
+
+void Clock::advance(uint64_t us) {
+    virtualMicros.fetch_add(us, std::memory_order_acq_rel);
+}
+
+#endif
+
+#if defined(ASYNC_HOST) && (ASYNC_CLOCK == ASYNC_CLOCK_ARDUINO || ASYNC_CLOCK == ASYNC_CLOCK_VIRTUAL)
+
+// The shim holds the only virtual time of a host build, so millis(), micros() and
+// delay() move along with the Clock
+void Clock::set(uint64_t us) {
+    host::setMicros(us);
+}
+
+void Clock::advance(uint64_t us) {
+    host::advanceMicros(us);
+}
+
+#endif
@@ -1,24 +1,613 @@
+#include <async/Task.h>
 #include "async/Log.h"
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if ASYNC_LOG_DEFERRED
+#include <async/MpscQueue.h>
+#include <atomic>
+#endif
+
+static char const * const LEVELS = "TDIWE";
+
+/**
+ * @brief Runtime level of one source file
+ */
+struct LogFileLevel {
+    char const * name;  ///< File name as given to Log::setLevel()
+    uint32_t hash;      ///< logHash() of name, for interned messages
+    int level;          ///< Lowest level written for the file
+};
+
+static int globalLevel = async::Log::LEVEL_TRACE;
+static LogFileLevel fileLevels[ASYNC_LOG_FILE_LEVELS];
+static size_t fileLevelCount = 0;
+
+void async::Log::setLevel(int level) {
+    globalLevel = level;
+}
+
+bool async::Log::setLevel(char const * file, int level) {
+    uint32_t hash = logHash(logBasename(file));
+
+    for(size_t i=0; i < fileLevelCount; i++) {
+        if(fileLevels[i].hash == hash) {
+            fileLevels[i].level = level;
+            return true;
+        }
+    }
+
+    if(fileLevelCount >= ASYNC_LOG_FILE_LEVELS) {
+        return false;
+    }
+
+    fileLevels[fileLevelCount].name = logBasename(file);
+    fileLevels[fileLevelCount].hash = hash;
+    fileLevels[fileLevelCount].level = level;
+    fileLevelCount++;
+    return true;
+}
+
+/**
+ * @details A file matches when its path ends with the registered name at a path
+ * separator, so "Main.cpp" matches both "Main.cpp" and "src/Main.cpp".
+ */
+bool async::Log::enabled(int level, char const * file) {
+    if(fileLevelCount > 0 && file != nullptr) {
+        size_t length = strlen(file);
+
+        for(size_t i=0; i < fileLevelCount; i++) {
+            size_t size = strlen(fileLevels[i].name);
+
+            if(size <= length && strcmp(file + length - size, fileLevels[i].name) == 0 &&
+                    (size == length || file[length - size - 1] == '/' || file[length - size - 1] == '\\')) {
+                return level >= fileLevels[i].level;
+            }
+        }
+    }
+
+    return level >= globalLevel;
+}
+
+bool async::Log::enabled(int level, uint32_t file) {
+    for(size_t i=0; i < fileLevelCount; i++) {
+        if(fileLevels[i].hash == file) {
+            return level >= fileLevels[i].level;
+        }
+    }
+
+    return level >= globalLevel;
+}
+
+async::LogLine::LogLine(int level, uint32_t file, uint32_t id) : at(0) {
+    append("~%llu %d%c %08lx %08lx", (unsigned long long) Time::getSystem().getTimestamp(),
+        (int) xPortGetCoreID(), LEVELS[level < 0 ? 0 : level > 4 ? 4 : level], (unsigned long) file, (unsigned long) id);
+}
+
+void async::LogLine::append(char const * format, ...) {
+    if(at >= sizeof(buf) - 1) {
+        return;
+    }
 
-void log(int level, const char *format, const char * file, ...) {
     va_list args;
     va_start(args, format);
-    //if(level < 2) return;
-    //char buf[512];  // Buffer for storing log message
-        
-    //char new_format[50];
+    int written = vsnprintf(buf + at, sizeof(buf) - at, format, args);
+    va_end(args);
+
+    if(written > 0) {
+        at += (size_t) written < sizeof(buf) - at ? written : sizeof(buf) - at - 1;
+    }
+}
+
+async::LogLine & async::LogLine::operator<<(int value) {
+    append(" %d", value);
+    return *this;
+}
+
+async::LogLine & async::LogLine::operator<<(unsigned int value) {
+    append(" %u", value);
+    return *this;
+}
+
+async::LogLine & async::LogLine::operator<<(long value) {
+    append(" %ld", value);
+    return *this;
+}
+
+async::LogLine & async::LogLine::operator<<(unsigned long value) {
+    append(" %lu", value);
+    return *this;
+}
+
+async::LogLine & async::LogLine::operator<<(long long value) {
+    append(" %lld", value);
+    return *this;
+}
+
+async::LogLine & async::LogLine::operator<<(unsigned long long value) {
+    append(" %llu", value);
+    return *this;
+}
+
+async::LogLine & async::LogLine::operator<<(double value) {
+    append(" %.17g", value);
+    return *this;
+}
+
+async::LogLine & async::LogLine::operator<<(long double value) {
+    append(" %.17g", (double) value);
+    return *this;
+}
+
+/**
+ * @details Strings are written as "<length>:<bytes>" so they may contain spaces; the
+ * length is that of the part that fits into the line.
+ */
+async::LogLine & async::LogLine::operator<<(char const * value) {
+    if(value == nullptr) {
+        value = "(null)";
+    }
+
+    // " <length>:" takes at most 5 characters in a 256 byte line
+    size_t length = strlen(value);
+    size_t room = sizeof(buf) - 1 - at;
+
+    if(room <= 5) {
+        return *this;
+    }
+
+    if(length > room - 5) {
+        length = room - 5;
+    }
+
+    append(" %u:", (unsigned) length);
+    memcpy(buf + at, value, length);
+    at += length;
+    buf[at] = 0;
+    return *this;
+}
+
+async::LogLine & async::LogLine::operator<<(void const * value) {
+    append(" %llu", (unsigned long long) (uintptr_t) value);
+    return *this;
+}
+
+void async::LogLine::end() {
+    buf[at] = 0;
+    Serial.println(buf);
+}
+
+/**
+ * @brief Write the "<time> [<file>\t<core>][<level>] " line prefix
+ * @param time Timestamp formatted by Time::toChar() or TimeFormatter
+ * @return int Number of characters written
+ */
+static int prefix(char * buf, size_t size, char const * time, char const * file, int core, int level) {
+    return snprintf(buf, size, "%.23s [%s\t%d][%c] ", time, file, core, LEVELS[level < 0 ? 0 : level > 4 ? 4 : level]);
+}
+
+#if !ASYNC_LOG_DEFERRED
+
+void log(int level, const char *format, const char * file, ...) {
+    if(!async::Log::enabled(level, file)) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, file);
+
+    char time[24];
+    async::Time::getSystem().toChar(time, async::Time::getSystem().getTimestamp());
+
     char buf[512];
-    char new_format[256];
+    int length = prefix(buf, sizeof(buf), time, file, xPortGetCoreID(), level);
 
-    sprintf(new_format, "%s [%s\t%d][%s] %s", 
-            async::Time::getSystem().toString().c_str(), 
-            file, 
-            xPortGetCoreID(), 
-            level == 0 ? "T" : level == 1 ? "D" : level == 2 ? "I" : level == 3 ? "W" : "E", 
-            format);
+    if(length > 0 && length < (int) sizeof(buf)) {
+        vsnprintf(buf + length, sizeof(buf) - length, format, args);
+    }
 
-    vsnprintf(buf, 512, new_format, args);
     Serial.println(buf);
 
     va_end(args);
-}
\ No newline at end of file
+}
+
+size_t async::Log::drain(size_t max) {
+    (void) max;
+    return 0;
+}
+
+uint32_t async::Log::dropped() {
+    return 0;
+}
+
+async::Task * async::Log::drainTask(size_t batch) {
+    (void) batch;
+    return nullptr;
+}
+
+#else
+
+/**
+ * @brief A log call captured for later formatting
+ *
+ * @details Arguments are stored widened to 64 bits in the order they were passed,
+ * string arguments as an offset into text.
+ */
+struct LogRecord {
+    union Arg {
+        int64_t i;
+        uint64_t u;
+        double d;
+        const void * p;
+    };
+
+    char const * format;
+    char const * file;
+    uint64_t timestamp;
+    uint8_t level;
+    uint8_t core;
+    uint8_t argc;
+    Arg args[ASYNC_LOG_MAX_ARGS];
+    char text[ASYNC_LOG_TEXT_SIZE];
+};
+
+/**
+ * @brief One parsed printf conversion
+ */
+struct LogSpec {
+    char const * start;     ///< Points at '%'
+    char const * length;    ///< First length modifier character, or the conversion
+    char const * end;       ///< One past the conversion character
+    char modifier;          ///< 0, 'H' (hh), 'h', 'l', 'q' (ll), 'L', 'z', 'j' or 't'
+    char conversion;        ///< Conversion character, 0 if the format ended early
+    uint8_t stars;          ///< Number of '*' width/precision arguments
+};
+
+static async::MpscQueue<LogRecord, ASYNC_LOG_QUEUE_SIZE> queue;
+static std::atomic<uint32_t> lost(0);
+static async::TimeFormatter stamps;  ///< Only used by the draining context
+static std::atomic<async::Task *> drainer(nullptr); ///< Task created by drainTask()
+static std::atomic<bool> signalled(false);          ///< drainer was demanded and has not drained since
+
+/**
+ * @brief Parse the conversion starting at '%'
+ * @return char const* Position after the conversion
+ */
+static char const * parse(char const * p, LogSpec & spec) {
+    spec.start = p++;
+    spec.stars = 0;
+    spec.modifier = 0;
+
+    while(*p && strchr("-+ #0", *p)) {
+        p++;
+    }
+
+    if(*p == '*') {
+        spec.stars++;
+        p++;
+    }
+
+    while(*p >= '0' && *p <= '9') {
+        p++;
+    }
+
+    if(*p == '.') {
+        p++;
+
+        if(*p == '*') {
+            spec.stars++;
+            p++;
+        }
+
+        while(*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+
+    spec.length = p;
+
+    if(*p == 'h' || *p == 'l') {
+        spec.modifier = *p++;
+
+        if(*p == spec.modifier) {
+            spec.modifier = spec.modifier == 'h' ? 'H' : 'q';
+            p++;
+        }
+    }
+    else if(*p && strchr("Lzjt", *p)) {
+        spec.modifier = *p++;
+    }
+
+    spec.conversion = *p;
+
+    if(*p) {
+        p++;
+    }
+
+    spec.end = p;
+    return p;
+}
+
+static int64_t signedArg(char modifier, va_list & args) {
+    switch(modifier) {
+        case 'H': return (signed char) va_arg(args, int);
+        case 'h': return (short) va_arg(args, int);
+        case 'l': return va_arg(args, long);
+        case 'q': return va_arg(args, long long);
+        case 'z': return (int64_t) va_arg(args, size_t);
+        case 'j': return va_arg(args, intmax_t);
+        case 't': return va_arg(args, ptrdiff_t);
+        default: return va_arg(args, int);
+    }
+}
+
+static uint64_t unsignedArg(char modifier, va_list & args) {
+    switch(modifier) {
+        case 'H': return (unsigned char) va_arg(args, unsigned int);
+        case 'h': return (unsigned short) va_arg(args, unsigned int);
+        case 'l': return va_arg(args, unsigned long);
+        case 'q': return va_arg(args, unsigned long long);
+        case 'z': return va_arg(args, size_t);
+        case 'j': return va_arg(args, uintmax_t);
+        case 't': return (uint64_t) va_arg(args, ptrdiff_t);
+        default: return va_arg(args, unsigned int);
+    }
+}
+
+/**
+ * @details Only copies: the arguments are read with the types their conversions
+ * name, the same way vsnprintf() would, and string arguments are copied because
+ * they may be gone by the time the record is drained.
+ */
+void log(int level, const char *format, const char * file, ...) {
+    if(!async::Log::enabled(level, file)) {
+        return;
+    }
+
+    LogRecord record;
+    record.format = format;
+    record.file = file;
+    record.timestamp = async::Time::getSystem().getTimestamp();
+    record.level = level;
+    record.core = xPortGetCoreID();
+    record.argc = 0;
+
+    va_list args;
+    va_start(args, file);
+
+    size_t used = 0;
+    LogSpec spec;
+
+    for(char const * p = format; *p && record.argc < ASYNC_LOG_MAX_ARGS; ) {
+        if(*p != '%') {
+            p++;
+            continue;
+        }
+
+        if(p[1] == '%') {
+            p += 2;
+            continue;
+        }
+
+        p = parse(p, spec);
+
+        for(int i=0; i < spec.stars && record.argc < ASYNC_LOG_MAX_ARGS; i++) {
+            record.args[record.argc++].i = va_arg(args, int);
+        }
+
+        if(record.argc >= ASYNC_LOG_MAX_ARGS) {
+            break;
+        }
+
+        LogRecord::Arg & arg = record.args[record.argc];
+
+        switch(spec.conversion) {
+            case 'd': case 'i':
+                arg.i = signedArg(spec.modifier, args);
+                break;
+            case 'u': case 'o': case 'x': case 'X':
+                arg.u = unsignedArg(spec.modifier, args);
+                break;
+            case 'c':
+                arg.i = va_arg(args, int);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                arg.d = spec.modifier == 'L' ? (double) va_arg(args, long double) : va_arg(args, double);
+                break;
+            case 'p':
+                arg.p = va_arg(args, void *);
+                break;
+            case 's': {
+                char const * text = va_arg(args, char const *);
+                size_t length = text ? strlen(text) : 0;
+
+                if(text == nullptr || used >= sizeof(record.text)) {
+                    arg.u = UINT64_MAX;
+                    break;
+                }
+
+                if(length > sizeof(record.text) - used - 1) {
+                    length = sizeof(record.text) - used - 1;
+                }
+
+                memcpy(record.text + used, text, length);
+                record.text[used + length] = 0;
+                arg.u = used;
+                used += length + 1;
+                break;
+            }
+            case 'n':
+                va_arg(args, void *);
+                continue;
+            default:
+                continue;
+        }
+
+        record.argc++;
+    }
+
+    va_end(args);
+
+    if(!queue.push(record)) {
+        lost.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Only the first message after a drain demands the drain task
+    async::Task * task = drainer.load(std::memory_order_acquire);
+
+    if(task != nullptr && !signalled.exchange(true, std::memory_order_acq_rel)) {
+        task->demand();
+    }
+}
+
+/**
+ * @brief snprintf() a single conversion with its width/precision arguments
+ */
+template<typename V>
+static int emit(char * out, size_t size, char const * spec, LogRecord const & record, int star, int stars, V value) {
+    switch(stars) {
+        case 0: return snprintf(out, size, spec, value);
+        case 1: return snprintf(out, size, spec, (int) record.args[star].i, value);
+        default: return snprintf(out, size, spec, (int) record.args[star].i, (int) record.args[star + 1].i, value);
+    }
+}
+
+/**
+ * @brief Format a record into buf, the same text the immediate mode would produce
+ */
+static void format(LogRecord const & record, char * buf, size_t size) {
+    char time[24];
+    stamps.format(time, record.timestamp);
+
+    int length = prefix(buf, size, time, record.file, record.core, record.level);
+    size_t at = length > 0 ? length : 0;
+    uint8_t next = 0;
+    LogSpec spec;
+
+    for(char const * p = record.format; *p && at < size - 1; ) {
+        if(*p != '%') {
+            buf[at++] = *p++;
+            continue;
+        }
+
+        if(p[1] == '%') {
+            buf[at++] = '%';
+            p += 2;
+            continue;
+        }
+
+        p = parse(p, spec);
+
+        bool known = spec.conversion && strchr("diuoxXcfFeEgGaAps", spec.conversion);
+        bool missing = next + spec.stars + 1 > record.argc;
+
+        if(spec.conversion == 'n') {
+            continue;
+        }
+
+        if(!known || missing) {
+            // Unsupported or not captured, show the conversion itself
+            size_t count = spec.end - spec.start;
+            if(count > size - 1 - at) {
+                count = size - 1 - at;
+            }
+            memcpy(buf + at, spec.start, count);
+            at += count;
+            continue;
+        }
+
+        // Same flags, width and precision with the length modifier of the stored value
+        char conversion[32];
+        size_t keep = spec.length - spec.start;
+        if(keep > sizeof(conversion) - 4) {
+            keep = sizeof(conversion) - 4;
+        }
+        memcpy(conversion, spec.start, keep);
+
+        char * tail = conversion + keep;
+        if(strchr("diuoxX", spec.conversion)) {
+            *tail++ = 'l';
+            *tail++ = 'l';
+        }
+        *tail++ = spec.conversion;
+        *tail = 0;
+
+        int star = next;
+        LogRecord::Arg const & arg = record.args[next + spec.stars];
+        next += spec.stars + 1;
+
+        char * out = buf + at;
+        size_t room = size - at;
+        int written;
+
+        switch(spec.conversion) {
+            case 'd': case 'i':
+                written = emit(out, room, conversion, record, star, spec.stars, (long long) arg.i);
+                break;
+            case 'u': case 'o': case 'x': case 'X':
+                written = emit(out, room, conversion, record, star, spec.stars, (unsigned long long) arg.u);
+                break;
+            case 'c':
+                written = emit(out, room, conversion, record, star, spec.stars, (int) arg.i);
+                break;
+            case 'p':
+                written = emit(out, room, conversion, record, star, spec.stars, arg.p);
+                break;
+            case 's':
+                written = emit(out, room, conversion, record, star, spec.stars,
+                    arg.u == UINT64_MAX ? "(null)" : record.text + arg.u);
+                break;
+            default:
+                written = emit(out, room, conversion, record, star, spec.stars, arg.d);
+                break;
+        }
+
+        if(written > 0) {
+            at += (size_t) written < room ? written : room - 1;
+        }
+    }
+
+    buf[at < size ? at : size - 1] = 0;
+}
+
+size_t async::Log::drain(size_t max) {
+    LogRecord record;
+    char buf[512];
+    size_t count = 0;
+
+    // Messages logged from now on demand the drain task again; an exchange, so a
+    // producer that still saw the old flag has its record visible to pop()
+    signalled.exchange(false, std::memory_order_acq_rel);
+
+    while(count < max && queue.pop(record)) {
+        format(record, buf, sizeof(buf));
+        Serial.println(buf);
+        count++;
+    }
+
+    return count;
+}
+
+uint32_t async::Log::dropped() {
+    return lost.load(std::memory_order_relaxed);
+}
+
+async::Task * async::Log::drainTask(size_t batch) {
+    auto task = new Task(Task::DEMAND, [batch]() {
+        if(Log::drain(batch) == batch && !queue.empty()) {
+            drainer.load(std::memory_order_relaxed)->demand();
+        }
+    });
+
+    task->setPriority(Tick::PRIORITY_LOW);
+    drainer.store(task, std::memory_order_release);
+
+    // Write what was logged before the task existed
+    task->demand();
+    return task;
+}
+
+#endif
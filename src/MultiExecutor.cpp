@@ -0,0 +1,336 @@
+#include <async/MultiExecutor.h>
+#include <async/Trace.h>
+
+#if defined(ARDUINO_ARCH_ESP32) || !defined(ARDUINO)
+
+#if !defined(ARDUINO)
+    #include <chrono>
+#endif
+
+using namespace async;
+
+/**
+ * @brief Give up the CPU while a background worker has nothing to run
+ */
+static void idle() {
+#if defined(ARDUINO_ARCH_ESP32)
+    vTaskDelay(1);
+#else
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+#endif
+}
+
+MultiExecutor::MultiExecutor(int count) : running(false), alive(0), stolen(0) {
+    if(count < 1) {
+        count = 1;
+    }
+
+    for(int i=0; i < count; i++) {
+        Worker * worker = new Worker();
+        worker->owner = this;
+        worker->index = i;
+        workers.push_back(worker);
+    }
+}
+
+MultiExecutor::~MultiExecutor() {
+    stop();
+
+    for(size_t i=0; i < workers.size(); i++) {
+        TickList * lists[] = { &workers[i]->list, &workers[i]->visited };
+
+        for(TickList * from : lists) {
+            while(Tick * tick = from->first()) {
+                from->remove(tick);
+                destroy(tick);
+            }
+        }
+
+        delete workers[i];
+    }
+}
+
+bool MultiExecutor::start() {
+    if(this->running.load()) {
+        return true;
+    }
+
+    this->begin = true;
+    this->running = true;
+
+    for(size_t i=1; i < workers.size(); i++) {
+        Worker * worker = workers[i];
+        alive++;
+
+#if defined(ARDUINO_ARCH_ESP32)
+        int core = (xPortGetCoreID() + i) % portNUM_PROCESSORS;
+        xTaskCreatePinnedToCore(work, "async", ASYNC_WORKER_STACK_SIZE, worker,
+            ASYNC_WORKER_PRIORITY, &worker->handle, core);
+#else
+        worker->thread = std::thread(work, worker);
+#endif
+    }
+
+    return true;
+}
+
+bool MultiExecutor::stop() {
+    this->running = false;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    while(alive.load() > 0) {
+        vTaskDelay(1);
+    }
+#else
+    for(size_t i=1; i < workers.size(); i++) {
+        if(workers[i]->thread.joinable()) {
+            workers[i]->thread.join();
+        }
+    }
+#endif
+
+    return true;
+}
+
+void MultiExecutor::destroy(Tick * tick) {
+    tick->cancel();
+
+    if(tick->isOwned()) {
+        delete tick;
+    }
+}
+
+void MultiExecutor::add(Tick * tick) {
+    if(this->begin) {
+        tick->start();
+    }
+
+    int target = tick->getAffinity();
+
+    if(target < 0 || target >= (int) workers.size()) {
+        size_t shortest = (size_t) -1;
+        target = 0;
+
+        for(size_t i=0; i < workers.size(); i++) {
+            std::lock_guard<std::mutex> guard(workers[i]->lock);
+            size_t length = workers[i]->list.size() + workers[i]->visited.size();
+
+            if(length < shortest) {
+                shortest = length;
+                target = i;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(workers[target]->lock);
+    workers[target]->list.pushBack(tick);
+}
+
+void MultiExecutor::remove(Tick * tick) {
+    bool found = false;
+
+    // A Tick only moves between workers while both of their locks are held, so
+    // holding every lock (in index order) pins it to one place
+    for(size_t i=0; i < workers.size(); i++) {
+        workers[i]->lock.lock();
+    }
+
+    TickList * owner = TickList::of(tick);
+
+    if(owner != nullptr) {
+        owner->remove(tick);
+        found = true;
+    }
+    else {
+        for(size_t i=0; i < workers.size(); i++) {
+            if(workers[i]->current == tick) {
+                workers[i]->currentRemoved = true;
+            }
+        }
+    }
+
+    for(size_t i=workers.size(); i > 0; i--) {
+        workers[i - 1]->lock.unlock();
+    }
+
+    if(found) {
+        destroy(tick);
+    }
+}
+
+/**
+ * @details Must be called with the lock of the worker held. Objects that are not
+ * runnable are moved to the visited list on the way, so a pass looks at every object
+ * once and the scan never starts over from the head.
+ */
+Tick * MultiExecutor::take(Worker & self, uint64_t now) {
+    while(Tick * tick = self.list.first()) {
+        self.list.remove(tick);
+
+        if(tick->wakeTime() <= now) {
+            return tick;
+        }
+
+        self.visited.pushBack(tick);
+    }
+
+    return nullptr;
+}
+
+/**
+ * @details Must be called with the locks of both workers held. Only busy victims are
+ * robbed, so an idle worker never takes work its owner is about to run anyway.
+ */
+Tick * MultiExecutor::steal(Worker & victim, uint64_t now) {
+    if(victim.current == nullptr) {
+        return nullptr;
+    }
+
+    TickList * lists[] = { &victim.list, &victim.visited };
+
+    for(TickList * from : lists) {
+        for(Tick * tick = from->first(); tick != nullptr; tick = TickList::next(tick)) {
+            if(tick->getAffinity() == ANY && tick->wakeTime() <= now) {
+                from->remove(tick);
+                stolen++;
+                return tick;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Start a new pass of a worker
+ */
+void MultiExecutor::endPass(Worker & self) {
+    std::lock_guard<std::mutex> guard(self.lock);
+    self.list.splice(self.visited);
+}
+
+/**
+ * @brief Run the next runnable object of a worker's pass, or one stolen from a busy worker
+ * @param stealing Look at the other workers if the pass has nothing left to run
+ * @return true if an object was run, false if nothing was runnable
+ */
+bool MultiExecutor::step(Worker & self, bool stealing) {
+    uint64_t now = uptimeMicros();
+    Tick * tick = nullptr;
+
+    {
+        std::lock_guard<std::mutex> guard(self.lock);
+        tick = take(self, now);
+
+        if(tick != nullptr) {
+            self.current = tick;
+        }
+    }
+
+    for(size_t i=1; tick == nullptr && stealing && i < workers.size(); i++) {
+        Worker & victim = *workers[(self.index + i) % workers.size()];
+        Worker & first = victim.index < self.index ? victim : self;
+        Worker & second = victim.index < self.index ? self : victim;
+        std::lock_guard<std::mutex> firstGuard(first.lock);
+        std::lock_guard<std::mutex> secondGuard(second.lock);
+        tick = steal(victim, now);
+
+        if(tick != nullptr) {
+            self.current = tick;
+        }
+    }
+
+    if(tick == nullptr) {
+        return false;
+    }
+
+    ASYNC_TRACE_EVENT(Trace::BEGIN, Trace::DISPATCH, tick, 0);
+    bool keep = tick->tick();
+    ASYNC_TRACE_EVENT(Trace::END, Trace::DISPATCH, tick, 0);
+
+    {
+        std::lock_guard<std::mutex> guard(self.lock);
+        self.current = nullptr;
+
+        if(self.currentRemoved) {
+            self.currentRemoved = false;
+            keep = false;
+        }
+        else if(keep) {
+            self.visited.pushBack(tick);
+        }
+    }
+
+    if(!keep) {
+        destroy(tick);
+    }
+
+    return true;
+}
+
+void MultiExecutor::work(void * arg) {
+    Worker * self = (Worker *) arg;
+    MultiExecutor * owner = self->owner;
+
+    while(owner->running.load()) {
+        if(owner->step(*self, false)) {
+            continue;
+        }
+
+        owner->endPass(*self);
+
+        if(!owner->step(*self, true)) {
+            idle();
+        }
+    }
+
+    owner->alive--;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    vTaskDelete(NULL);
+#endif
+}
+
+bool MultiExecutor::tick() {
+    Worker & self = *workers[0];
+    bool ran = false;
+
+    // Every owned object once, or a single stolen one when none is runnable
+    while(step(self, false)) {
+        ran = true;
+    }
+
+    if(!ran) {
+        step(self, true);
+    }
+
+    endPass(self);
+    return true;
+}
+
+uint64_t MultiExecutor::wakeTime() {
+    Worker & self = *workers[0];
+    std::lock_guard<std::mutex> guard(self.lock);
+    uint64_t next = NEVER;
+    TickList * lists[] = { &self.list, &self.visited };
+
+    for(TickList * from : lists) {
+        for(Tick * tick = from->first(); tick != nullptr && next > 0; tick = TickList::next(tick)) {
+            uint64_t time = tick->wakeTime();
+
+            if(time < next) {
+                next = time;
+            }
+        }
+    }
+
+    return next;
+}
+
+size_t MultiExecutor::size(int worker) {
+    Worker & target = *workers.at(worker);
+    std::lock_guard<std::mutex> guard(target.lock);
+    return target.list.size() + target.visited.size();
+}
+
+#endif
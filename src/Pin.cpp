@@ -1,9 +1,21 @@
 #include <async/Pin.h>
+#include <async/Trace.h>
 
 using namespace async;
 
 IRAM_ATTR void ISR(void* arg) {
-    Task *ptr = (Task*) arg;
+    Pin *ptr = (Pin*) arg;
     //ets_printf("Button press\n");
-	ptr->demand();
+	ptr->interrupt();
+}
+
+IRAM_ATTR void Pin::interrupt() {
+    ASYNC_TRACE_EVENT(Trace::INSTANT, Trace::INTERRUPT, this, 0);
+    PinEvent event = { pin, ::digitalRead(pin), (uint32_t) micros() };
+
+    if(!events.push(event)) {
+        overflows = overflows + 1;
+    }
+
+    this->wake();
 }
@@ -0,0 +1,215 @@
+#include <async/Sleep.h>
+#include <async/Clock.h>
+#include <async/Config.h>
+#include <async/CriticalSection.h>
+#include <Arduino.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+    #include <driver/gpio.h>
+    #include <esp_sleep.h>
+#elif !defined(ARDUINO)
+    #include <chrono>
+#endif
+
+using namespace async;
+
+static Sleep::Waiter customWaiter = nullptr;
+static uint64_t lightSleepMs = 0;
+
+#if defined(ARDUINO_ARCH_ESP32)
+/**
+ * @brief Pin that ends light sleep
+ */
+struct WakePin {
+    int pin = -1;                           ///< GPIO number, -1 for a free slot
+    Sleep::PinHandler handler = nullptr;    ///< Interrupt handler of the pin
+    void * arg = nullptr;                   ///< Handler argument
+};
+
+static WakePin wakePins[ASYNC_SLEEP_WAKE_PINS];
+static CriticalSection wakePinLock;
+
+/**
+ * @brief Light sleep until the timeout or a level change of a wake pin
+ *
+ * @details gpio_wakeup_enable() turns the pin interrupt into a level interrupt, so the
+ * interrupt is masked while asleep and the edge that ended the sleep is handed to the
+ * handler here, after the edge interrupt was restored.
+ */
+static void lightSleep(uint64_t ms) {
+    WakePin pins[ASYNC_SLEEP_WAKE_PINS];
+    int levels[ASYNC_SLEEP_WAKE_PINS];
+
+    wakePinLock.lock();
+    for(int i=0; i < ASYNC_SLEEP_WAKE_PINS; i++) {
+        pins[i] = wakePins[i];
+    }
+    wakePinLock.unlock();
+
+    for(int i=0; i < ASYNC_SLEEP_WAKE_PINS; i++) {
+        if(pins[i].pin < 0) {
+            continue;
+        }
+
+        gpio_num_t gpio = (gpio_num_t) pins[i].pin;
+        levels[i] = gpio_get_level(gpio);
+        gpio_intr_disable(gpio);
+        gpio_wakeup_enable(gpio, levels[i] ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    }
+
+    esp_sleep_enable_gpio_wakeup();
+    esp_sleep_enable_timer_wakeup(ms * 1000ULL);
+    esp_light_sleep_start();
+
+    for(int i=0; i < ASYNC_SLEEP_WAKE_PINS; i++) {
+        if(pins[i].pin < 0) {
+            continue;
+        }
+
+        gpio_num_t gpio = (gpio_num_t) pins[i].pin;
+        gpio_wakeup_disable(gpio);
+        gpio_set_intr_type(gpio, GPIO_INTR_ANYEDGE);
+
+        if(gpio_get_level(gpio) != levels[i]) {
+            pins[i].handler(pins[i].arg);
+        }
+
+        gpio_intr_enable(gpio);
+    }
+}
+#endif
+
+Sleep::~Sleep() {
+#if defined(ARDUINO_ARCH_ESP32)
+    if(semaphore != nullptr) {
+        vSemaphoreDelete(semaphore);
+    }
+#endif
+}
+
+bool Sleep::wait(uint64_t ms) {
+    if(customWaiter != nullptr) {
+        if(pending.exchange(false)) {
+            return true;
+        }
+
+        customWaiter(ms);
+        return pending.exchange(false);
+    }
+
+#if defined(ARDUINO_ARCH_ESP32)
+    if(semaphore == nullptr) {
+        semaphore = xSemaphoreCreateBinary();
+    }
+
+    TickType_t ticks = ms == FOREVER || ms / portTICK_PERIOD_MS >= portMAX_DELAY
+        ? portMAX_DELAY : (TickType_t) (ms / portTICK_PERIOD_MS);
+
+    if(lightSleepMs > 0 && ms != FOREVER && ms >= lightSleepMs && !pending.load()) {
+        lightSleep(ms);
+
+        // The time is spent already: only collect a wake() given meanwhile
+        ticks = 0;
+    }
+
+    xSemaphoreTake(semaphore, pending.load() ? 0 : ticks);
+    return pending.exchange(false);
+#elif defined(ARDUINO)
+    uint64_t from = Clock::millis();
+
+    while(!pending.load() && (ms == FOREVER || Clock::millis() - from < ms)) {
+        yield();
+    }
+
+    return pending.exchange(false);
+#else
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if(ms == FOREVER) {
+        condition.wait(lock, [this] { return pending.load(); });
+    }
+    else {
+        condition.wait_for(lock, std::chrono::milliseconds(ms), [this] { return pending.load(); });
+    }
+
+    return pending.exchange(false);
+#endif
+}
+
+void Sleep::wake() {
+    pending.store(true);
+
+#if defined(ARDUINO_ARCH_ESP32)
+    if(semaphore == nullptr) {
+        return;
+    }
+
+    if(xPortInIsrContext()) {
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(semaphore, &woken);
+
+        if(woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+    else {
+        xSemaphoreGive(semaphore);
+    }
+#elif !defined(ARDUINO)
+    std::lock_guard<std::mutex> lock(mutex);
+    condition.notify_all();
+#endif
+}
+
+void Sleep::setWaiter(Waiter waiter) {
+    customWaiter = waiter;
+}
+
+void Sleep::setLightSleep(uint64_t ms) {
+    lightSleepMs = ms;
+}
+
+void Sleep::addWakePin(uint8_t pin, PinHandler handler, void * arg) {
+#if defined(ARDUINO_ARCH_ESP32)
+    wakePinLock.lock();
+    WakePin * slot = nullptr;
+
+    for(int i=0; i < ASYNC_SLEEP_WAKE_PINS; i++) {
+        if(wakePins[i].pin == pin || (slot == nullptr && wakePins[i].pin < 0)) {
+            slot = &wakePins[i];
+
+            if(wakePins[i].pin == pin) {
+                break;
+            }
+        }
+    }
+
+    if(slot != nullptr) {
+        slot->pin = pin;
+        slot->handler = handler;
+        slot->arg = arg;
+    }
+
+    wakePinLock.unlock();
+#else
+    (void) pin;
+    (void) handler;
+    (void) arg;
+#endif
+}
+
+void Sleep::removeWakePin(uint8_t pin) {
+#if defined(ARDUINO_ARCH_ESP32)
+    wakePinLock.lock();
+
+    for(int i=0; i < ASYNC_SLEEP_WAKE_PINS; i++) {
+        if(wakePins[i].pin == pin) {
+            wakePins[i] = WakePin();
+        }
+    }
+
+    wakePinLock.unlock();
+#else
+    (void) pin;
+#endif
+}
@@ -0,0 +1,87 @@
+#include <async/Trace.h>
+
+#if ASYNC_TRACE
+#include <atomic>
+
+using namespace async;
+
+static_assert((ASYNC_TRACE_SIZE & (ASYNC_TRACE_SIZE - 1)) == 0, "ASYNC_TRACE_SIZE must be a power of two");
+
+static Trace::Event events[ASYNC_TRACE_SIZE];
+static std::atomic<uint32_t> head(0);
+
+IRAM_ATTR void Trace::record(int phase, int kind, Tick * object, int arg) {
+    Event & event = events[head.fetch_add(1, std::memory_order_relaxed) & (ASYNC_TRACE_SIZE - 1)];
+    event.time = micros();
+    event.object = object;
+    event.name = object->getName();
+    event.phase = phase;
+    event.kind = kind;
+    event.arg = arg;
+    event.core = xPortGetCoreID();
+}
+
+static const char * kindName(int kind) {
+    switch(kind) {
+        case Trace::DISPATCH:   return "dispatch";
+        case Trace::INTERRUPT:  return "interrupt";
+        case Trace::DEMAND:     return "demand";
+        case Trace::CHAIN_STEP: return "step";
+        case Trace::STATE_SET:  return "state";
+        default:                return "event";
+    }
+}
+
+void Trace::dump(Print & out) {
+    uint32_t last = head.load();
+    uint32_t first = last > ASYNC_TRACE_SIZE ? last - ASYNC_TRACE_SIZE : 0;
+    uint64_t time = 0;
+    uint32_t previous = 0;
+
+    out.print("{\"traceEvents\":[");
+
+    for(uint32_t i = first; i < last; i++) {
+        const Event & event = events[i & (ASYNC_TRACE_SIZE - 1)];
+
+        // Unwrap the 32-bit timestamps, events are stored in recording order
+        time = i == first ? event.time : time + (uint32_t) (event.time - previous);
+        previous = event.time;
+
+        static const char phases[] = { 'B', 'E', 'i' };
+
+        out.printf("%s\n{\"name\":\"", i == first ? "" : ",");
+
+        if(event.name != nullptr && event.name[0] != '\0') {
+            out.print(event.name);
+        }
+        else {
+            out.printf("%s %p", kindName(event.kind), event.object);
+        }
+
+        out.printf("\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%llu,\"pid\":0,\"tid\":%u",
+            kindName(event.kind), phases[event.phase], (unsigned long long) time, event.core);
+
+        if(event.phase == INSTANT) {
+            out.print(",\"s\":\"t\"");
+        }
+
+        if(event.kind == CHAIN_STEP) {
+            out.printf(",\"args\":{\"step\":%u}", event.arg);
+        }
+
+        out.print("}");
+    }
+
+    out.print("\n]}\n");
+}
+
+void Trace::clear() {
+    head = 0;
+}
+
+size_t Trace::size() {
+    uint32_t count = head.load();
+    return count > ASYNC_TRACE_SIZE ? ASYNC_TRACE_SIZE : count;
+}
+
+#endif
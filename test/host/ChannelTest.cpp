@@ -0,0 +1,153 @@
+#include "Check.h"
+#include <async/Executor.h>
+#include <async/Channel.h>
+#include <thread>
+#include <vector>
+
+/**
+ * @file ChannelTest.cpp
+ * @brief Channel overflow policies and the demand of its consumer Task
+ */
+
+using namespace async;
+
+typedef Channel<int, 4> Small;
+
+/**
+ * @brief Take every waiting element
+ */
+static std::vector<int> drainAll(Small & channel) {
+    std::vector<int> items;
+    channel.drain([&](const int & item) { items.push_back(item); });
+    return items;
+}
+
+/**
+ * @brief A full DROP_NEWEST channel rejects new elements and keeps the first ones
+ */
+static void testDropNewest() {
+    Small channel(Small::DROP_NEWEST);
+    int rejected = 0;
+
+    for(int i=0; i < 6; i++) {
+        if(!channel.send(i)) {
+            rejected++;
+        }
+    }
+
+    CHECK_EQ(rejected, 2);
+    CHECK_EQ(channel.getDropped(), 2);
+
+    std::vector<int> items = drainAll(channel);
+    CHECK_EQ(items.size(), 4);
+
+    for(size_t i=0; i < items.size(); i++) {
+        CHECK_EQ(items[i], i);
+    }
+
+    CHECK(channel.empty());
+}
+
+/**
+ * @brief A full DROP_OLDEST channel discards old elements and keeps the last ones
+ */
+static void testDropOldest() {
+    Small channel(Small::DROP_OLDEST);
+
+    for(int i=0; i < 6; i++) {
+        CHECK(channel.send(i));
+    }
+
+    CHECK_EQ(channel.getDropped(), 2);
+
+    std::vector<int> items = drainAll(channel);
+    CHECK_EQ(items.size(), 4);
+
+    for(size_t i=0; i < items.size(); i++) {
+        CHECK_EQ(items[i], i + 2);
+    }
+}
+
+/**
+ * @brief A BLOCK sender waits for the consumer, nothing is lost or reordered
+ */
+static void testBlock() {
+    const int COUNT = 1000;
+    Small channel(Small::BLOCK);
+    int expected = 0;
+    bool ordered = true;
+
+    std::thread producer([&channel]() {
+        for(int i=0; i < COUNT; i++) {
+            channel.send(i);
+        }
+    });
+
+    while(expected < COUNT) {
+        int item;
+
+        if(!channel.receive(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if(item != expected) {
+            ordered = false;
+        }
+
+        expected++;
+    }
+
+    producer.join();
+    CHECK(ordered);
+    CHECK_EQ(channel.getDropped(), 0);
+}
+
+/**
+ * @brief A burst demands the consumer once, drain(max) demands it again for the rest
+ */
+static void testConsumer() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    Channel<int, 16> channel;
+    int runs = 0;
+    int received = 0;
+
+    channel.setConsumer(executor.onDemand([&]() {
+        runs++;
+        received += channel.drain([](const int &) {}, 4);
+    }));
+
+    executor.tick();
+    CHECK_EQ(runs, 0);
+
+    for(int i=0; i < 3; i++) {
+        channel.send(i);
+    }
+
+    executor.tick();
+    executor.tick();
+    CHECK_EQ(runs, 1);
+    CHECK_EQ(received, 3);
+
+    for(int i=0; i < 10; i++) {
+        channel.send(i);
+    }
+
+    for(int i=0; i < 10; i++) {
+        executor.tick();
+    }
+
+    CHECK_EQ(runs, 4);
+    CHECK_EQ(received, 13);
+    CHECK(channel.empty());
+}
+
+int main() {
+    testDropNewest();
+    testDropOldest();
+    testBlock();
+    testConsumer();
+
+    return finish("channel");
+}
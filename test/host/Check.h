@@ -0,0 +1,59 @@
+#pragma once
+#include <Arduino.h>
+#include <async/Clock.h>
+#include <stdio.h>
+
+/**
+ * @file Check.h
+ * @brief Minimal assertions for the host tests run by ctest
+ *
+ * @details Every test is a plain program: CHECK() prints the failed condition with its
+ * location and the test carries on, finish() prints the verdict and returns the exit
+ * code for main(). Tests that need time stop the clock with useTestClock() and move it
+ * with advanceClock() only, so they are deterministic and do not sleep. CMake registers
+ * them only for clock backends that can be moved (ASYNC_VIRTUAL_TIME).
+ */
+
+static int checkFailures = 0;
+
+#define CHECK(condition) do { \
+        if(!(condition)) { \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            checkFailures++; \
+        } \
+    } while(0)
+
+#define CHECK_EQ(actual, expected) do { \
+        long long checkActual = (long long) (actual); \
+        long long checkExpected = (long long) (expected); \
+        if(checkActual != checkExpected) { \
+            printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, \
+                #actual, #expected, checkActual, checkExpected); \
+            checkFailures++; \
+        } \
+    } while(0)
+
+/**
+ * @brief Stop the clock, it only moves through advanceClock() and delay() from now on
+ */
+static inline void useTestClock() {
+    host::useVirtualClock(true);
+}
+
+/**
+ * @brief Move the clock forward
+ * @param us Microseconds to add
+ */
+static inline void advanceClock(uint64_t us) {
+    async::Clock::advance(us);
+}
+
+/**
+ * @brief Print the verdict of a test
+ * @param name Test name
+ * @return int Exit code, 0 if every check passed
+ */
+static inline int finish(const char * name) {
+    printf("%s: %s\n", name, checkFailures == 0 ? "ok" : "FAILED");
+    return checkFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+#include "Check.h"
+#include <async/Executor.h>
+#include <async/Coroutine.h>
+
+/**
+ * @file CoroutineTest.cpp
+ * @brief A suspended coroutine stays out of the polling list until its condition wakes it
+ */
+
+using namespace async;
+
+static int const PIN = 5;
+
+/**
+ * @brief Tick until nothing changes any more
+ */
+static void settle(Executor & executor) {
+    for(int i=0; i < 5; i++) {
+        executor.tick();
+    }
+}
+
+static co_task<void> waitEdge(Pin * pin, int * done) {
+    bool fired = co_await pin->edge(FALLING);
+
+    if(fired) {
+        (*done)++;
+    }
+}
+
+static co_task<void> waitSemaphore(Semaphore * semaphore, int * done) {
+    co_await *semaphore;
+    (*done)++;
+    semaphore->release();
+}
+
+static co_task<void> sleepLong() {
+    co_await co::delay(60000);
+}
+
+/**
+ * @brief An edge without timeout reports NEVER, the pin edge resumes the coroutine
+ */
+static void testEdge() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    host::setPin(PIN, HIGH);
+
+    Pin pin(PIN);
+    pin.setOwned(false);
+    executor.add(&pin);
+
+    int done = 0;
+    CoroutineTick * tick = spawn(waitEdge(&pin, &done));
+    executor.add(tick);
+    settle(executor);
+
+    CHECK_EQ(done, 0);
+    CHECK(tick->deadline() == Tick::NEVER);
+
+    host::setPin(PIN, LOW);
+    settle(executor);
+
+    CHECK_EQ(done, 1);
+}
+
+/**
+ * @brief A coroutine queued on a semaphore stays parked until release() wakes it
+ */
+static void testSemaphore() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    Semaphore semaphore(1, 1);
+    CHECK(semaphore.tryAcquire());
+
+    int done = 0;
+    CoroutineTick * tick = spawn(waitSemaphore(&semaphore, &done));
+    executor.add(tick);
+    settle(executor);
+
+    CHECK_EQ(done, 0);
+    CHECK(tick->deadline() == Tick::NEVER);
+
+    semaphore.release();
+    settle(executor);
+
+    CHECK_EQ(done, 1);
+    CHECK_EQ(semaphore.available(), 1);
+}
+
+/**
+ * @brief A delay reports its end as the deadline
+ */
+static void testDelay() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+
+    CoroutineTick * tick = spawn(sleepLong());
+    executor.add(tick);
+    settle(executor);
+
+    CHECK(tick->deadline() > uptimeMicros());
+    CHECK(tick->deadline() != Tick::NEVER);
+}
+
+int main() {
+    testEdge();
+    testSemaphore();
+    testDelay();
+
+    return finish("coroutine");
+}
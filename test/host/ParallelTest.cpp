@@ -0,0 +1,220 @@
+#include "Check.h"
+#include <async/Executor.h>
+#include <async/Chain.h>
+#include <async/Parallel.h>
+
+/**
+ * @file ParallelTest.cpp
+ * @brief Results, timing and deadlines of race(), all() and withTimeout() groups
+ */
+
+using namespace async;
+
+static const uint64_t MS = 1000;
+
+/**
+ * @brief Chain that is done after a delay
+ *
+ * @details A Chain runs one step per tick, so it reports being done on the tick after
+ * its delay ended: 1 ms later with the loop below.
+ */
+static Chain<> * wait(unsigned long ms) {
+    return (new Chain<>())->delay(ms);
+}
+
+/**
+ * @brief Chain that is done once it acquired and released a semaphore
+ */
+static Chain<> * acquire(Semaphore * semaphore) {
+    return (new Chain<>())
+        ->semaphoreWaitAcquire(semaphore)
+        ->then([semaphore]() { semaphore->release(); });
+}
+
+/**
+ * @brief Tick the executor once per millisecond
+ * @param ms Milliseconds to run
+ * @param result Group result, watched for the first change
+ * @return int Milliseconds until the result changed, -1 if it never did
+ */
+static int run(Executor & executor, unsigned long ms, int & result) {
+    int initial = result;
+
+    for(unsigned long i=0; i < ms; i++) {
+        advanceClock(1 * MS);
+        executor.tick();
+
+        if(result != initial) {
+            return (int) i + 1;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief race() reports the first child, even when added before start()
+ */
+static void testRace() {
+    Executor executor(Executor::TIMERS);
+    int result = -2;
+
+    executor.add(race(wait(10), wait(20))->then([&](int winner) { result = winner; }));
+    executor.start();
+    executor.tick();
+
+    CHECK_EQ(run(executor, 30, result), 11);
+    CHECK_EQ(result, 0);
+    CHECK_EQ(executor.size(), 0);
+}
+
+/**
+ * @brief all() waits for every child and reports the last one
+ */
+static void testAll() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    int result = -2;
+
+    executor.add(all(wait(10), wait(20))->then([&](int last) { result = last; }));
+    executor.tick();
+
+    CHECK_EQ(run(executor, 30, result), 21);
+    CHECK_EQ(result, 1);
+}
+
+/**
+ * @brief withTimeout() reports TIMEOUT when the child is too slow
+ */
+static void testTimeout() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    int result = -2;
+
+    Parallel * group = withTimeout(wait(50), 20)->then([&](int outcome) { result = outcome; });
+    executor.add(group);
+    executor.tick();
+
+    CHECK_EQ(run(executor, 60, result), 20);
+    CHECK_EQ(result, Parallel::TIMEOUT);
+
+    result = -2;
+    executor.add(withTimeout(wait(10), 20)->then([&](int outcome) { result = outcome; }));
+    executor.tick();
+
+    CHECK_EQ(run(executor, 30, result), 11);
+    CHECK_EQ(result, 0);
+}
+
+/**
+ * @brief A Chain await step continues once its group is done
+ */
+static void testAwait() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    int done = 0;
+
+    executor.add((new Chain<>())
+        ->await([]() { return race(wait(10), wait(30)); })
+        ->then([&]() { done++; }));
+    executor.tick();
+
+    // One more tick for the await step to see its group done
+    CHECK_EQ(run(executor, 40, done), 12);
+    CHECK_EQ(done, 1);
+}
+
+/**
+ * @brief A group reports the earliest deadline of its children or its timeout
+ */
+static void testDeadline() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+
+    Parallel * group = withTimeout(wait(50), 20);
+    executor.add(group);
+    executor.tick();
+    CHECK(group->deadline() == uptimeMicros() + 20 * MS);
+
+    Parallel * other = all(wait(5), wait(50));
+    executor.add(other);
+    executor.tick();
+    CHECK(other->deadline() == uptimeMicros() + 5 * MS);
+}
+
+/**
+ * @brief A group of parked children stays parked until a child is woken
+ */
+static void testWake() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    Semaphore semaphore(1, 1);
+    int result = -2;
+
+    CHECK(semaphore.tryAcquire());
+
+    Parallel * group = race(acquire(&semaphore), acquire(&semaphore))->then([&](int winner) { result = winner; });
+    executor.add(group);
+
+    for(int i=0; i < 5; i++) {
+        executor.tick();
+    }
+
+    CHECK(group->deadline() == Tick::NEVER);
+    CHECK_EQ(result, -2);
+
+    semaphore.release();
+
+    for(int i=0; i < 5 && result == -2; i++) {
+        executor.tick();
+    }
+
+    CHECK_EQ(result, 0);
+}
+
+/**
+ * @brief A Chain awaiting a parked group is parked as well and woken through it
+ */
+static void testAwaitWake() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    Semaphore semaphore(1, 1);
+    int done = 0;
+
+    CHECK(semaphore.tryAcquire());
+
+    Chain<> * chain = (new Chain<>())
+        ->await([&semaphore]() { return all(acquire(&semaphore)); })
+        ->then([&]() { done++; });
+    executor.add(chain);
+
+    for(int i=0; i < 5; i++) {
+        executor.tick();
+    }
+
+    CHECK(chain->deadline() == Tick::NEVER);
+    CHECK_EQ(done, 0);
+
+    semaphore.release();
+
+    for(int i=0; i < 5; i++) {
+        executor.tick();
+    }
+
+    CHECK_EQ(done, 1);
+    CHECK_EQ(executor.size(), 0);
+}
+
+int main() {
+    useTestClock();
+
+    testRace();
+    testAll();
+    testTimeout();
+    testAwait();
+    testDeadline();
+    testWake();
+    testAwaitWake();
+
+    return finish("parallel");
+}
@@ -0,0 +1,107 @@
+#include "Check.h"
+#include <async/Pool.h>
+#include <thread>
+#include <vector>
+
+/**
+ * @file PoolTest.cpp
+ * @brief Pool slot reuse, heap fallback and counters, also under contention
+ */
+
+using namespace async;
+
+struct Item {
+    uint64_t owner;
+    uint64_t sequence;
+
+    ASYNC_POOLED(Item, 64)
+};
+
+/**
+ * @brief Slots are handed out, reused and counted, overflows go to the heap
+ */
+static void testSlots() {
+    Pool<uint64_t, 4> pool;
+    void * slots[5];
+
+    for(int i=0; i < 5; i++) {
+        slots[i] = pool.allocate(sizeof(uint64_t));
+    }
+
+    for(int i=0; i < 4; i++) {
+        CHECK(pool.owns(slots[i]));
+    }
+
+    CHECK(!pool.owns(slots[4]));
+    CHECK_EQ(pool.used(), 4);
+    CHECK_EQ(pool.overflows(), 1);
+
+    pool.deallocate(slots[4]);
+    pool.deallocate(slots[1]);
+    CHECK_EQ(pool.used(), 3);
+
+    // The released slot is the next one handed out
+    void * again = pool.allocate(sizeof(uint64_t));
+    CHECK(again == slots[1]);
+
+    // Requests larger than a slot always use the heap
+    void * large = pool.allocate(2 * sizeof(uint64_t));
+    CHECK(!pool.owns(large));
+    CHECK_EQ(pool.overflows(), 2);
+    pool.deallocate(large);
+
+    for(int i=0; i < 4; i++) {
+        pool.deallocate(slots[i]);
+    }
+
+    CHECK_EQ(pool.used(), 0);
+    CHECK_EQ(pool.highWater(), 4);
+    CHECK_EQ(pool.capacity(), 4);
+}
+
+/**
+ * @brief Threads allocating and releasing at once never share a slot
+ */
+static void testThreads() {
+    const int THREADS = 4;
+    const int ROUNDS = 20000;
+    std::vector<std::thread> threads;
+    std::atomic<int> collisions(0);
+
+    for(int t=0; t < THREADS; t++) {
+        threads.push_back(std::thread([t, &collisions]() {
+            Item * held[8];
+
+            for(int round=0; round < ROUNDS; round++) {
+                for(int i=0; i < 8; i++) {
+                    held[i] = new Item();
+                    held[i]->owner = t;
+                    held[i]->sequence = round * 8 + i;
+                }
+
+                for(int i=0; i < 8; i++) {
+                    if(held[i]->owner != (uint64_t) t || held[i]->sequence != (uint64_t) (round * 8 + i)) {
+                        collisions++;
+                    }
+
+                    delete held[i];
+                }
+            }
+        }));
+    }
+
+    for(size_t i=0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+
+    CHECK_EQ(collisions.load(), 0);
+    CHECK_EQ(Item::pool().used(), 0);
+    CHECK(Item::pool().highWater() <= 64);
+}
+
+int main() {
+    testSlots();
+    testThreads();
+
+    return finish("pool");
+}
@@ -0,0 +1,168 @@
+#include "Check.h"
+#include <async/RingBuffer.h>
+#include <async/MpscQueue.h>
+#include <thread>
+#include <vector>
+
+/**
+ * @file QueueTest.cpp
+ * @brief RingBuffer (one producer) and MpscQueue (many producers), alone and across threads
+ */
+
+using namespace async;
+
+static const uint32_t COUNT = 200000;
+
+/**
+ * @brief Elements come out in order and a full buffer rejects new ones
+ */
+static void testRingBuffer() {
+    RingBuffer<int, 4> buffer;
+    int item = 0;
+
+    CHECK(buffer.empty());
+    CHECK(!buffer.pop(item));
+
+    for(int i=0; i < 4; i++) {
+        CHECK(buffer.push(i));
+    }
+
+    CHECK(!buffer.push(4));
+    CHECK_EQ(buffer.size(), 4);
+
+    for(int i=0; i < 4; i++) {
+        CHECK(buffer.pop(item));
+        CHECK_EQ(item, i);
+    }
+
+    CHECK(buffer.empty());
+}
+
+/**
+ * @brief One producer thread, one consumer thread, nothing lost or reordered
+ */
+static void testRingBufferThreads() {
+    static RingBuffer<uint32_t, 64> buffer;
+    uint32_t expected = 0;
+    bool ordered = true;
+
+    std::thread producer([]() {
+        for(uint32_t i=0; i < COUNT; i++) {
+            while(!buffer.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    while(expected < COUNT) {
+        uint32_t item;
+
+        if(!buffer.pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if(item != expected) {
+            ordered = false;
+        }
+
+        expected++;
+    }
+
+    producer.join();
+    CHECK(ordered);
+    CHECK(buffer.empty());
+}
+
+/**
+ * @brief Elements come out in order and a full queue rejects new ones
+ */
+static void testMpscQueue() {
+    MpscQueue<int, 4> queue;
+    int item = 0;
+
+    CHECK(queue.empty());
+    CHECK(!queue.pop(item));
+
+    for(int i=0; i < 4; i++) {
+        CHECK(queue.push(i));
+    }
+
+    CHECK(!queue.push(4));
+
+    for(int i=0; i < 4; i++) {
+        CHECK(queue.pop(item));
+        CHECK_EQ(item, i);
+    }
+
+    CHECK(queue.empty());
+
+    // Positions wrap around the cells
+    for(int i=0; i < 10; i++) {
+        CHECK(queue.push(i));
+        CHECK(queue.pop(item));
+        CHECK_EQ(item, i);
+    }
+}
+
+/**
+ * @brief Several producer threads: every element arrives once, in order per producer
+ */
+static void testMpscQueueThreads() {
+    const int PRODUCERS = 4;
+    static MpscQueue<uint32_t, 64> queue;
+    std::vector<std::thread> producers;
+    uint32_t next[PRODUCERS] = {};
+    uint32_t received = 0;
+    bool ordered = true;
+
+    for(int p=0; p < PRODUCERS; p++) {
+        producers.push_back(std::thread([p]() {
+            for(uint32_t i=0; i < COUNT; i++) {
+                while(!queue.push(((uint32_t) p << 24) | i)) {
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+
+    while(received < PRODUCERS * COUNT) {
+        uint32_t item;
+
+        if(!queue.pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        uint32_t producer = item >> 24;
+
+        if(producer >= PRODUCERS || (item & 0xFFFFFF) != next[producer]) {
+            ordered = false;
+        }
+        else {
+            next[producer]++;
+        }
+
+        received++;
+    }
+
+    for(size_t i=0; i < producers.size(); i++) {
+        producers[i].join();
+    }
+
+    CHECK(ordered);
+    CHECK(queue.empty());
+
+    for(int p=0; p < PRODUCERS; p++) {
+        CHECK_EQ(next[p], COUNT);
+    }
+}
+
+int main() {
+    testRingBuffer();
+    testRingBufferThreads();
+    testMpscQueue();
+    testMpscQueueThreads();
+
+    return finish("queues");
+}
@@ -0,0 +1,154 @@
+#include "Check.h"
+#include <async/Executor.h>
+#include <async/Chain.h>
+#include <async/StaticChain.h>
+#include <vector>
+
+/**
+ * @file SemaphoreTest.cpp
+ * @brief Waiters get the permit in the order they queued, nobody overtakes them
+ */
+
+using namespace async;
+
+static std::vector<int> order;
+
+/**
+ * @brief Chain that waits for the semaphore, records its turn and releases
+ */
+static Chain<> * waiter(Semaphore * semaphore, int id) {
+    return (new Chain<>())
+        ->semaphoreWaitAcquire(semaphore)
+        ->then([semaphore, id]() {
+            order.push_back(id);
+            semaphore->release();
+        });
+}
+
+/**
+ * @brief Tick until nothing changes any more
+ */
+static void settle(Executor & executor) {
+    for(int i=0; i < 20; i++) {
+        executor.tick();
+    }
+}
+
+/**
+ * @brief Chains queued on a taken semaphore run in FIFO order, plain tryAcquire() waits too
+ */
+static void testFifo() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    Semaphore semaphore(1, 1);
+    order.clear();
+
+    CHECK(semaphore.tryAcquire());
+
+    for(int i=0; i < 5; i++) {
+        executor.add(waiter(&semaphore, i));
+        executor.tick();
+    }
+
+    settle(executor);
+    CHECK(order.empty());
+
+    semaphore.release();
+    CHECK_EQ(semaphore.available(), 1);
+    CHECK(!semaphore.tryAcquire());
+
+    settle(executor);
+    CHECK_EQ(order.size(), 5);
+
+    for(size_t i=0; i < order.size(); i++) {
+        CHECK_EQ(order[i], i);
+    }
+
+    CHECK(semaphore.tryAcquire());
+}
+
+/**
+ * @brief A StaticChain waits its turn between Chains and stays parked meanwhile
+ */
+static void testStaticChain() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    Semaphore semaphore(1, 1);
+    order.clear();
+
+    auto chain = makeChain(
+        step::acquire(&semaphore),
+        step::then([&semaphore]() {
+            order.push_back(1);
+            semaphore.release();
+        }));
+
+    CHECK(semaphore.tryAcquire());
+
+    executor.add(waiter(&semaphore, 0));
+    executor.tick();
+    executor.add(&chain);
+    executor.tick();
+    executor.add(waiter(&semaphore, 2));
+    settle(executor);
+
+    CHECK(order.empty());
+    CHECK(chain.deadline() == Tick::NEVER);
+
+    semaphore.release();
+    settle(executor);
+
+    CHECK_EQ(order.size(), 3);
+
+    for(size_t i=0; i < order.size(); i++) {
+        CHECK_EQ(order[i], i);
+    }
+
+    CHECK(chain.finished());
+}
+
+/**
+ * @brief A forgotten waiter does not block the ones behind it
+ */
+static void testForget() {
+    Semaphore semaphore(1, 1);
+    Task first(Task::DEMAND, nullptr, []() {});
+    Task second(Task::DEMAND, nullptr, []() {});
+
+    CHECK(semaphore.tryAcquire());
+    CHECK(!semaphore.tryAcquire(&first));
+    CHECK(!semaphore.tryAcquire(&second));
+
+    semaphore.release();
+    CHECK(semaphore.ready(&first));
+    CHECK(!semaphore.ready(&second));
+
+    semaphore.forget(&first);
+    CHECK(semaphore.ready(&second));
+    CHECK(semaphore.tryAcquire(&second));
+    CHECK_EQ(semaphore.available(), 0);
+}
+
+/**
+ * @brief A Mutex has one permit
+ */
+static void testMutex() {
+    Mutex mutex;
+
+    CHECK(mutex.tryLock());
+    CHECK(mutex.isLocked());
+    CHECK(!mutex.tryLock());
+
+    mutex.unlock();
+    CHECK(!mutex.isLocked());
+    CHECK(mutex.tryLock());
+}
+
+int main() {
+    testFifo();
+    testStaticChain();
+    testForget();
+    testMutex();
+
+    return finish("semaphore");
+}
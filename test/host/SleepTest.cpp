@@ -0,0 +1,192 @@
+#include "Check.h"
+#include <async/Executor.h>
+#include <async/Sleep.h>
+#include <thread>
+
+/**
+ * @file SleepTest.cpp
+ * @brief Executor::sleep() idles until the next deadline, wake() ends it early
+ */
+
+using namespace async;
+
+static uint64_t requested = 0;  ///< Last timeout passed to the waiter
+static int waits = 0;           ///< Number of waiter calls
+static Task * interrupt = nullptr; ///< Demanded by the waiter, like an ISR would
+
+/**
+ * @brief Waiter that jumps the virtual clock instead of blocking
+ */
+static void jump(uint64_t ms) {
+    requested = ms;
+    waits++;
+
+    if(interrupt != nullptr) {
+        interrupt->demand();
+        interrupt = nullptr;
+        return;
+    }
+
+    if(ms != Sleep::FOREVER) {
+        advanceClock(ms * 1000);
+    }
+}
+
+/**
+ * @brief sleep() asks for exactly the time until the next deadline
+ */
+static void testDeadline() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    int runs = 0;
+
+    executor.onRepeat(50, [&]() { runs++; });
+    executor.tick();
+    CHECK_EQ(executor.idleTime(), 50);
+
+    CHECK(!executor.sleep());
+    CHECK_EQ(requested, 50);
+    executor.tick();
+    CHECK_EQ(runs, 1);
+}
+
+/**
+ * @brief With every object parked the loop sleeps without timeout until a wake()
+ */
+static void testParked() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    int runs = 0;
+
+    Task * task = executor.onDemand([&]() { runs++; });
+    executor.tick();
+    CHECK(executor.idleTime() == Tick::NEVER);
+
+    interrupt = task;
+    CHECK(executor.sleep());
+    CHECK(requested == Sleep::FOREVER);
+
+    executor.tick();
+    CHECK_EQ(runs, 1);
+    CHECK(executor.idleTime() == Tick::NEVER);
+}
+
+/**
+ * @brief A wake() made while the loop is busy keeps the next sleep() from waiting
+ */
+static void testPending() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    Task * task = nullptr;
+    int runs = 0;
+
+    task = executor.onDemand([&]() { runs++; });
+    executor.onRepeat(1000, [&]() { task->demand(); });
+    advanceClock(1000000);
+    executor.tick();
+
+    int before = waits;
+    executor.sleep();
+    CHECK_EQ(waits, before);
+
+    executor.tick();
+    CHECK_EQ(runs, 1);
+}
+
+/**
+ * @brief The host backend is woken by another thread
+ */
+static void testThread() {
+    Sleep::setWaiter(nullptr);
+
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    int runs = 0;
+
+    Task * task = executor.onDemand([&]() { runs++; });
+    executor.tick();
+
+    std::thread producer([task]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        task->demand();
+    });
+
+    CHECK(executor.sleep());
+    producer.join();
+
+    executor.tick();
+    CHECK_EQ(runs, 1);
+}
+
+/**
+ * @brief A wake() ends the sleep of the executor managing the object, not of another one
+ */
+static void testIsolated() {
+    Executor first(Executor::TIMERS);
+    Executor second(Executor::TIMERS);
+    first.start();
+    second.start();
+    std::atomic<bool> asleep(true);
+
+    Task * own = first.onDemand([]() {});
+    Task * other = second.onDemand([]() {});
+    first.tick();
+    second.tick();
+
+    std::thread sleeper([&]() {
+        second.sleep();
+        asleep = false;
+    });
+
+    // Both wake the first executor only, its sleep() returns at once
+    own->demand();
+    first.stop();
+    first.sleep();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    CHECK(asleep.load());
+
+    other->demand();
+    sleeper.join();
+    CHECK(!asleep.load());
+}
+
+/**
+ * @brief A wake() inside a nested executor ends the sleep of the outer one
+ */
+static void testNested() {
+    Executor outer(Executor::TIMERS);
+    outer.start();
+    Executor * inner = new Executor(Executor::TIMERS);
+    inner->start();
+    int runs = 0;
+
+    Task * task = inner->onDemand([&]() { runs++; });
+    outer.add(inner);
+    outer.tick();
+
+    std::thread waker([task]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        task->demand();
+    });
+
+    CHECK(outer.sleep());
+    waker.join();
+
+    outer.tick();
+    CHECK_EQ(runs, 1);
+}
+
+int main() {
+    useTestClock();
+    Sleep::setWaiter(jump);
+
+    testDeadline();
+    testParked();
+    testPending();
+    testThread();
+    testIsolated();
+    testNested();
+
+    return finish("sleep");
+}
@@ -0,0 +1,85 @@
+#include "Check.h"
+#include <async/Executor.h>
+#include <async/StaticChain.h>
+
+/**
+ * @file StaticChainTest.cpp
+ * @brief An edge step keeps its chain parked until the pin wakes it
+ */
+
+using namespace async;
+
+static int const PIN = 4;
+
+/**
+ * @brief Tick until nothing changes any more
+ */
+static void settle(Executor & executor) {
+    for(int i=0; i < 5; i++) {
+        executor.tick();
+    }
+}
+
+/**
+ * @brief Waiting for an edge without timeout reports NEVER, the edge finishes the step
+ */
+static void testEdge() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    host::setPin(PIN, HIGH);
+
+    Pin pin(PIN);
+    pin.setOwned(false);
+    executor.add(&pin);
+
+    int done = 0;
+    auto chain = makeChain(
+        step::edge(&pin, FALLING),
+        step::then([&done]() { done++; }));
+
+    executor.add(&chain);
+    settle(executor);
+
+    CHECK_EQ(done, 0);
+    CHECK(chain.deadline() == Tick::NEVER);
+
+    host::setPin(PIN, LOW);
+    settle(executor);
+
+    CHECK_EQ(done, 1);
+    CHECK(chain.finished());
+}
+
+/**
+ * @brief A cancelled chain is no longer woken by the pin
+ */
+static void testCancel() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    host::setPin(PIN, HIGH);
+
+    Pin pin(PIN);
+    pin.setOwned(false);
+    executor.add(&pin);
+
+    int done = 0;
+    auto chain = makeChain(
+        step::edge(&pin, FALLING),
+        step::then([&done]() { done++; }));
+
+    executor.add(&chain);
+    settle(executor);
+    executor.remove(&chain);
+
+    host::setPin(PIN, LOW);
+    settle(executor);
+
+    CHECK_EQ(done, 0);
+}
+
+int main() {
+    testEdge();
+    testCancel();
+
+    return finish("staticchain");
+}
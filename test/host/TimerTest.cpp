@@ -0,0 +1,160 @@
+#include "Check.h"
+#include <async/Executor.h>
+
+/**
+ * @file TimerTest.cpp
+ * @brief DELAY and REPEAT tasks and the repeat policies, in both executor modes
+ */
+
+using namespace async;
+
+static const uint64_t MS = 1000;
+
+/**
+ * @brief A DELAY task fires once, at its time, and leaves the executor
+ */
+static void testDelay(int mode) {
+    Executor executor(mode);
+    executor.start();
+    int runs = 0;
+
+    executor.onDelay(10, [&]() { runs++; });
+    executor.tick();
+    advanceClock(9 * MS);
+    executor.tick();
+    CHECK_EQ(runs, 0);
+
+    advanceClock(1 * MS);
+    executor.tick();
+    CHECK_EQ(runs, 1);
+    CHECK_EQ(executor.size(), 0);
+
+    advanceClock(100 * MS);
+    executor.tick();
+    CHECK_EQ(runs, 1);
+}
+
+/**
+ * @brief A REPEAT task fires once per period while the loop keeps up
+ */
+static void testRepeat(int mode) {
+    Executor executor(mode);
+    executor.start();
+    int runs = 0;
+
+    executor.onRepeat(10, [&]() { runs++; });
+
+    for(int i=0; i < 100; i++) {
+        advanceClock(1 * MS);
+        executor.tick();
+    }
+
+    CHECK_EQ(runs, 10);
+    CHECK_EQ(executor.idleTime(), 10);
+}
+
+/**
+ * @brief Run a 10 ms REPEAT task across a 35 ms stall
+ * @param policy Repeat policy
+ * @param[out] overruns Overrun counter after the stall
+ * @return int Runs at the end of the stall
+ */
+static int stall(int policy, uint32_t & overruns) {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    int runs = 0;
+
+    Task * task = executor.onRepeat(10, [&]() { runs++; })->setPolicy(policy);
+    advanceClock(35 * MS);
+
+    // Without time passing, so only periods that are already due may run
+    for(int i=0; i < 10; i++) {
+        executor.tick();
+    }
+
+    overruns = task->getOverruns();
+    return runs;
+}
+
+static void testPolicies() {
+    uint32_t overruns = 0;
+
+    CHECK_EQ(stall(Task::FIXED_DELAY, overruns), 1);
+
+    CHECK_EQ(stall(Task::CATCH_UP, overruns), 3);
+    CHECK_EQ(overruns, 2);
+
+    CHECK_EQ(stall(Task::COALESCE, overruns), 1);
+    CHECK_EQ(overruns, 2);
+
+    CHECK_EQ(stall(Task::SKIP, overruns), 0);
+    CHECK_EQ(overruns, 2);
+}
+
+/**
+ * @brief Fixed-rate periods stay on their grid, FIXED_DELAY restarts at the late run
+ */
+static void testGrid() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    uint64_t start = uptimeMicros();
+
+    Task * fixedRate = executor.onRepeat(10, []() {})->setPolicy(Task::CATCH_UP);
+    Task * fixedDelay = executor.onRepeat(10, []() {});
+
+    advanceClock(13 * MS);
+    executor.tick();
+
+    CHECK_EQ(fixedRate->deadline() - start, 20 * MS);
+    CHECK_EQ(fixedDelay->deadline() - start, 23 * MS);
+}
+
+/**
+ * @brief A reset() made earlier in the same pass does not fire the task
+ */
+static void testResetInPass() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    int runs = 0;
+    Task * repeat = nullptr;
+
+    executor.onDelay(10, [&]() {
+        advanceClock(1);
+        repeat->reset();
+    });
+    repeat = executor.onRepeat(10, [&]() { runs++; });
+
+    advanceClock(10 * MS);
+    executor.tick();
+    CHECK_EQ(runs, 0);
+
+    advanceClock(10 * MS);
+    executor.tick();
+    CHECK_EQ(runs, 1);
+}
+
+/**
+ * @brief A timed task that was never started is parked, not polled
+ */
+static void testUnstarted() {
+    Task task(Task::REPEAT, 10, []() {});
+    CHECK(task.deadline() == Tick::NEVER);
+
+    task.start();
+    CHECK(task.deadline() != Tick::NEVER);
+}
+
+int main() {
+    useTestClock();
+
+    testDelay(Executor::POLL);
+    testDelay(Executor::TIMERS);
+    testRepeat(Executor::POLL);
+    testRepeat(Executor::TIMERS);
+    testPolicies();
+    testGrid();
+    testResetInPass();
+    testUnstarted();
+
+    return finish("timers");
+}
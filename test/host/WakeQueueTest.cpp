@@ -0,0 +1,151 @@
+#include "Check.h"
+#include <async/Executor.h>
+#include <thread>
+
+/**
+ * @file WakeQueueTest.cpp
+ * @brief wake() queues a Tick once, detached objects are never queued or ticked
+ */
+
+using namespace async;
+
+/**
+ * @brief Tick counting its ticks, parked unless told otherwise
+ */
+class Probe : public Tick {
+    public:
+        std::atomic<int> ticks;
+        uint64_t wait = NEVER;
+
+        Probe() : ticks(0) {}
+
+        bool tick() override {
+            ticks++;
+            return true;
+        }
+
+        uint64_t deadline() override {
+            return wait;
+        }
+};
+
+/**
+ * @brief Repeated wakes queue the object once until the queue is drained
+ */
+static void testOnce() {
+    WakeQueue queue;
+    Probe probe;
+    int drained = 0;
+
+    queue.attach(&probe);
+    probe.wake();
+    probe.wake();
+    CHECK(!queue.empty());
+
+    queue.drain([&](Tick * tick) {
+        CHECK(tick == &probe);
+        drained++;
+    });
+
+    CHECK_EQ(drained, 1);
+    CHECK(queue.empty());
+
+    probe.wake();
+    queue.drain([&](Tick *) { drained++; });
+    CHECK_EQ(drained, 2);
+    queue.detach(&probe);
+}
+
+/**
+ * @brief detach() drops a queued object and later wakes are not queued
+ */
+static void testDetach() {
+    WakeQueue queue;
+    Probe first;
+    Probe second;
+    int drained = 0;
+
+    queue.attach(&first);
+    queue.attach(&second);
+    first.wake();
+    second.wake();
+
+    queue.detach(&first);
+    first.wake();
+
+    queue.drain([&](Tick * tick) {
+        CHECK(tick == &second);
+        drained++;
+    });
+
+    CHECK_EQ(drained, 1);
+    queue.detach(&second);
+}
+
+/**
+ * @brief A parked object is ticked again after a wake() from another thread
+ */
+static void testParked() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    Probe * probe = new Probe();
+
+    executor.add(probe);
+    executor.tick();
+    executor.tick();
+    CHECK_EQ(probe->ticks.load(), 0);
+
+    std::thread waker([probe]() { probe->wake(); });
+    waker.join();
+
+    executor.tick();
+    CHECK_EQ(probe->ticks.load(), 1);
+
+    executor.tick();
+    CHECK_EQ(probe->ticks.load(), 1);
+}
+
+/**
+ * @brief An object removed while another thread keeps waking it is not ticked again
+ */
+static void testRemoveWhileWoken() {
+    Executor executor(Executor::TIMERS);
+    executor.start();
+    Probe probe;
+    std::atomic<bool> running(true);
+    int stale = 0;
+
+    probe.setOwned(false);
+
+    std::thread waker([&]() {
+        while(running.load()) {
+            probe.wake();
+        }
+    });
+
+    for(int i=0; i < 2000; i++) {
+        executor.add(&probe);
+        executor.tick();
+        executor.remove(&probe);
+
+        int before = probe.ticks.load();
+        executor.tick();
+
+        if(probe.ticks.load() != before) {
+            stale++;
+        }
+    }
+
+    running = false;
+    waker.join();
+    CHECK_EQ(stale, 0);
+}
+
+int main() {
+    testOnce();
+    testDetach();
+    testParked();
+    testRemoveWhileWoken();
+
+    return finish("wakequeue");
+}
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""Expand interned log lines written with ASYNC_LOG_INTERN=1.
+
+The firmware prints "~<timestamp> <core><level> <file id> <format id> <args...>"
+instead of formatted text. This tool scans the sources for trace/debug/info/warn/error
+calls, hashes their format strings the same way as async::logHash() and rewrites
+every interned line into the usual "<time> [<file>\t<core>][<level>] <message>" form.
+Other lines pass through unchanged.
+
+    pio device monitor | tools/log_decode.py src include examples
+    tools/log_decode.py src < capture.txt
+"""
+
+import argparse
+import datetime
+import os
+import re
+import sys
+
+SOURCE_SUFFIXES = (".c", ".cc", ".cpp", ".h", ".hpp", ".ino")
+CALL = re.compile(r"\b(?:trace|debug|info|warn|error)\s*\(\s*(?=\")")
+SPEC = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|L|z|j|t)?([diuoxXcfFeEgGaAspn%])")
+ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "0": "\0", "\\": "\\", "\"": "\"", "'": "'",
+           "a": "\a", "b": "\b", "f": "\f", "v": "\v", "?": "?"}
+
+
+def log_hash(data):
+    """FNV-1a, identical to async::logHash()."""
+    value = 2166136261
+    for byte in data:
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def read_literals(text, position):
+    """Read adjacent C string literals starting at position, return (bytes, end)."""
+    result = bytearray()
+    while True:
+        while position < len(text) and text[position].isspace():
+            position += 1
+        if position >= len(text) or text[position] != "\"":
+            return bytes(result), position
+        position += 1
+        while position < len(text) and text[position] != "\"":
+            char = text[position]
+            if char == "\\":
+                position += 1
+                escape = text[position]
+                if escape == "x":
+                    digits = re.match(r"[0-9a-fA-F]+", text[position + 1:]).group(0)
+                    result.append(int(digits, 16) & 0xFF)
+                    position += len(digits)
+                elif escape in "01234567":
+                    digits = re.match(r"[0-7]{1,3}", text[position:]).group(0)
+                    result.append(int(digits, 8) & 0xFF)
+                    position += len(digits) - 1
+                else:
+                    result.extend(ESCAPES.get(escape, escape).encode("utf-8"))
+            else:
+                result.extend(char.encode("utf-8"))
+            position += 1
+        position += 1
+
+
+def sources(paths):
+    for root in paths:
+        if os.path.isfile(root):
+            yield root
+            continue
+        for directory, _, names in os.walk(root):
+            for name in names:
+                if name.endswith(SOURCE_SUFFIXES):
+                    yield os.path.join(directory, name)
+
+
+def scan(paths):
+    """Map format and file ids found under paths to their strings."""
+    formats, files = {}, {}
+    for path in sources(paths):
+        name = os.path.basename(path)
+        files[log_hash(name.encode("utf-8"))] = name
+        with open(path, encoding="utf-8", errors="replace") as source:
+            text = source.read()
+        for match in CALL.finditer(text):
+            data, _ = read_literals(text, match.end())
+            formats[log_hash(data)] = data.decode("utf-8", errors="replace")
+    return formats, files
+
+
+def split_args(text):
+    """Split the argument part of a line, strings are "<length>:<bytes>"."""
+    args, position = [], 0
+    while position < len(text):
+        if text[position] == " ":
+            position += 1
+            continue
+        match = re.match(r"(\d+):", text[position:])
+        token = re.match(r"\S+", text[position:]).group(0)
+        if match and not re.fullmatch(r"-?\d+(\.\d*)?([eE][-+]?\d+)?", token):
+            start = position + match.end()
+            length = int(match.group(1))
+            args.append(text[start:start + length])
+            position = start + length
+        else:
+            args.append(token)
+            position += len(token)
+    return args
+
+
+def expand(format, args):
+    """printf-style expansion with arguments taken in order."""
+    args = list(args)
+
+    def convert(match):
+        flags, width, precision, _, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        if conversion == "n":
+            return ""
+        try:
+            if width == "*":
+                width = str(int(args.pop(0)))
+            if precision == "*":
+                precision = str(int(args.pop(0)))
+            value = args.pop(0)
+        except (IndexError, ValueError):
+            return match.group(0)
+        spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "")
+        if conversion in "diu":
+            return (spec + "d") % int(value)
+        if conversion in "oxXc":
+            return (spec + conversion) % int(value)
+        if conversion in "aA":
+            return float(value).hex()
+        if conversion in "fFeEgG":
+            return (spec + conversion) % float(value)
+        if conversion == "p":
+            return (spec + "s") % hex(int(value))
+        return (spec + "s") % value
+
+    return SPEC.sub(convert, format)
+
+
+def decode(line, formats, files):
+    match = re.match(r"~(\d+) (\d+)([TDIWE]) ([0-9a-f]{8}) ([0-9a-f]{8})(.*)$", line)
+    if not match:
+        return line
+    timestamp, core, level, file_id, format_id, rest = match.groups()
+    time = datetime.datetime(1970, 1, 1) + datetime.timedelta(milliseconds=int(timestamp))
+    stamp = time.strftime("%Y-%m-%d %H:%M:%S.") + "%03d" % (time.microsecond // 1000)
+    name = files.get(int(file_id, 16), file_id)
+    format = formats.get(int(format_id, 16))
+    if format is None:
+        message = "<unknown format %s>%s" % (format_id, rest)
+    else:
+        message = expand(format, split_args(rest))
+    return "%s [%s\t%s][%s] %s" % (stamp, name, core, level, message)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("sources", nargs="*", default=["."], help="source files or directories")
+    parser.add_argument("-i", "--input", help="log capture to read instead of stdin")
+    options = parser.parse_args()
+
+    formats, files = scan(options.sources)
+    stream = open(options.input, encoding="utf-8", errors="replace") if options.input else sys.stdin
+    for line in stream:
+        print(decode(line.rstrip("\r\n"), formats, files), flush=True)
+
+
+if __name__ == "__main__":
+    main()